@@ -23,10 +23,85 @@ THE SOFTWARE.
  */
 
 #include "jarr.h"
+#include "jarr_limb.h"
+#include "jarr_simd.h"
 
-// the length in bits of a single element
-const jarr_element_length_t jarr_element_length
-        = (jarr_element_length_t) sizeof (jarr_element_t) * CHAR_BIT;
+#include <string.h>
+
+// the section functions shift 64 bit words at a time where the elements of a
+// word load as one little endian integer
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define jarr_word_sections 1
+#else
+#define jarr_word_sections 0
+#endif
+
+// elements per 64 bit word
+
+#define jarr_word_elements (8U / sizeof (jarr_element_t))
+
+// runs of fewer words than this are shifted inline rather than by a kernel
+
+#ifndef jarr_funnel_kernel_words
+#define jarr_funnel_kernel_words 8U
+#endif
+
+#if jarr_word_sections != 0
+
+// out word i = the 64 bits starting bits bits into byte 8i of in, reading
+// 8n + 1 bytes, 0 <= bits < 8. If up the words are done from the bottom, so out
+// may be the same as in or below it, otherwise from the top, so out may be
+// above it
+
+static void jarr_funnel(unsigned char * const out,
+                        unsigned char const* const in, size_t const n,
+                        unsigned int const bits, unsigned char const up)
+{
+    if (bits == 0U)
+    {
+        memmove(out, in, n * 8U);
+    }
+    else if (n >= jarr_funnel_kernel_words)
+    {
+        struct jarr_simd_kernels const* const kernels = jarr_simd_get_kernels();
+        if (up)
+        {
+            kernels->funnel(out, in, n, bits);
+        }
+        else
+        {
+            kernels->funnel_down(out, in, n, bits);
+        }
+    }
+    else
+    {
+        size_t i;
+        for (i = 0; i < n; ++i)
+        {
+            size_t const k = up ? i : n - (size_t) 1U - i;
+            uint64_t const w = jarr_simd_funnel_word(in + (k * 8U), bits);
+            memcpy(out + (k * 8U), &w, sizeof (w));
+        }
+    }
+}
+
+// the words that fit in out_bytes bytes of out when funnel shifted from offset
+// bytes into in, without reading past in_bytes
+
+static size_t jarr_funnel_words(size_t const out_bytes, size_t const offset,
+                                size_t const in_bytes)
+{
+    if (in_bytes <= offset)
+    {
+        return 0;
+    }
+    size_t const in_words = (in_bytes - offset - (size_t) 1U) / 8U;
+    size_t const out_words = out_bytes / 8U;
+    return (out_words < in_words) ? out_words : in_words;
+}
+
+#endif
 
 struct jarr jarr_init(jarr_element_t * const _arr,
                       jarr_length_t const _length_bits)
@@ -129,6 +204,23 @@ void jarr_write_section(struct jarr * const j, struct jarr const* const input,
 
         *element &= ((jarr_element_t) - 1 >> rshift);
 
+#if jarr_word_sections != 0
+        // whole words, each starting at the input byte holding its first bit,
+        // the last input element is left to be written exactly
+        size_t const in_bytes = (size_t) (input->last_element - input_element)
+                * sizeof (jarr_element_t);
+        size_t const words = jarr_funnel_words(in_bytes, rshift / 8U, in_bytes);
+        if (words != (size_t) 0U)
+        {
+            *element |= *input_element << lshift;
+            jarr_funnel((unsigned char*) (element + 1),
+                        (unsigned char const*) input_element + (rshift / 8U),
+                        words, rshift % 8U, 1);
+            element += words * jarr_word_elements;
+            input_element += words * jarr_word_elements;
+        }
+#endif
+
         while (input_element < input->last_element)
         {
             *element |= *input_element << lshift;
@@ -169,12 +261,9 @@ void jarr_write_section(struct jarr * const j, struct jarr const* const input,
     {
         // this handles the case where rshift = element_size which would
         // cause undefined behaviour when used in the shift operation
-        while (input_element < input->last_element)
-        {
-            *element = *input_element;
-            ++element;
-            ++input_element;
-        }
+        size_t const whole = (size_t) (input->last_element - input_element);
+        memmove(element, input_element, whole * sizeof (jarr_element_t));
+        element += whole;
         *element &= ~input->mask;
         *element |= jarr_get_lev(input);
     }
@@ -190,6 +279,20 @@ void jarr_read_section(struct jarr const* const j, struct jarr * const output,
     if (rshift != (jarr_element_length_t) 0U)
     {
         jarr_element_length_t const lshift = jarr_element_length - rshift;
+#if jarr_word_sections != 0
+        // whole words, each starting at the byte holding its first bit, the
+        // last output element is left to be read exactly
+        size_t const words = jarr_funnel_words(
+                (size_t) (output->last_element - output_element)
+                * sizeof (jarr_element_t), rshift / 8U,
+                (size_t) (j->limiter_element - element)
+                * sizeof (jarr_element_t));
+        jarr_funnel((unsigned char*) output_element,
+                    (unsigned char const*) element + (rshift / 8U), words,
+                    rshift % 8U, 1);
+        element += words * jarr_word_elements;
+        output_element += words * jarr_word_elements;
+#endif
         while (output_element < output->last_element)
         {
             *output_element = *element >> rshift;
@@ -209,199 +312,677 @@ void jarr_read_section(struct jarr const* const j, struct jarr * const output,
     {
         // this handles the case where rshift = element_size which would
         // cause undefined behaviour when used in the shift operation
-        while (output_element != output->limiter_element)
-        {
-            *output_element = *element;
-            ++element;
-            ++output_element;
-        }
+        memmove(output_element, element, output->length_elements
+                * sizeof (jarr_element_t));
     }
 }
 
 void jarr_bw_and(struct jarr * const out, struct jarr const* const in1,
                  struct jarr const* const in2)
 {
-    jarr_element_t* out_element = out->arr;
-    jarr_element_t const* in1_element = in1->arr;
-    jarr_element_t const* in2_element = in2->arr;
-    while (in1_element != in1->limiter_element)
-    {
-        *out_element = *in1_element & *in2_element;
-        ++out_element;
-        ++in1_element;
-        ++in2_element;
-    }
+    jarr_simd_get_kernels()->bw_and(out->arr, in1->arr, in2->arr,
+                                    in1->length_elements);
 }
 
 void jarr_bw_or(struct jarr * const out, struct jarr const* const in1,
                 struct jarr const* const in2)
 {
-    jarr_element_t* out_element = out->arr;
-    jarr_element_t const* in1_element = in1->arr;
-    jarr_element_t const* in2_element = in2->arr;
-    while (in1_element != in1->limiter_element)
-    {
-        *out_element = *in1_element | *in2_element;
-        ++out_element;
-        ++in1_element;
-        ++in2_element;
-    }
+    jarr_simd_get_kernels()->bw_or(out->arr, in1->arr, in2->arr,
+                                   in1->length_elements);
 }
 
 void jarr_bw_xor(struct jarr * const out, struct jarr const* const in1,
                  struct jarr const* const in2)
 {
-    jarr_element_t* out_element = out->arr;
-    jarr_element_t const* in1_element = in1->arr;
-    jarr_element_t const* in2_element = in2->arr;
-    while (in1_element != in1->limiter_element)
+    jarr_simd_get_kernels()->bw_xor(out->arr, in1->arr, in2->arr,
+                                    in1->length_elements);
+}
+
+void jarr_bw_not(struct jarr * const out, struct jarr const* const in)
+{
+    jarr_simd_get_kernels()->bw_not(out->arr, in->arr, in->length_elements);
+}
+
+void jarr_bw_andnot(struct jarr * const out, struct jarr const* const in1,
+                    struct jarr const* const in2)
+{
+    jarr_simd_get_kernels()->bw_andnot(out->arr, in1->arr, in2->arr,
+                                       in1->length_elements);
+}
+
+// evaluates any function of 3 jarrs in a single pass, bit
+// (in1 << 2) | (in2 << 1) | in3 of table is the output for those input bits
+
+void jarr_bw_ternary(struct jarr * const out, struct jarr const* const in1,
+                     struct jarr const* const in2,
+                     struct jarr const* const in3, unsigned char const table)
+{
+    jarr_simd_get_kernels()->bw_ternary(out->arr, in1->arr, in2->arr, in3->arr,
+                                        in1->length_elements, table);
+}
+
+// the number of elements jarr_bw_quaternary evaluates at a time, its
+// temporaries stay in the l1 cache
+
+#define jarr_quaternary_chunk (4096U / sizeof (jarr_element_t))
+
+// evaluates any function of 4 jarrs, bit
+// (in1 << 3) | (in2 << 2) | (in3 << 1) | in4 of table is the output for those
+// input bits. The function is split on in4 into 2 functions of the other 3,
+// which are evaluated a cache sized chunk at a time and then selected between
+// by in4
+
+void jarr_bw_quaternary(struct jarr * const out, struct jarr const* const in1,
+                        struct jarr const* const in2,
+                        struct jarr const* const in3,
+                        struct jarr const* const in4, uint16_t const table)
+{
+    struct jarr_simd_kernels const* const kernels = jarr_simd_get_kernels();
+    unsigned char table0 = 0;
+    unsigned char table1 = 0;
+    unsigned int k;
+    for (k = 0; k < 8U; ++k)
     {
-        *out_element = *in1_element ^ *in2_element;
-        ++out_element;
-        ++in1_element;
-        ++in2_element;
+        table0 |= (unsigned char) (((table >> (k << 1)) & 1U) << k);
+        table1 |= (unsigned char) (((table >> ((k << 1) | 1U)) & 1U) << k);
+    }
+
+    jarr_element_t tmp[2][jarr_quaternary_chunk];
+    size_t const n = in1->length_elements;
+    size_t i;
+    for (i = 0; i < n; i += jarr_quaternary_chunk)
+    {
+        size_t const m = (n - i < jarr_quaternary_chunk) ? n - i
+                : jarr_quaternary_chunk;
+        kernels->bw_ternary(tmp[0], in1->arr + i, in2->arr + i, in3->arr + i,
+                            m, table0);
+        kernels->bw_ternary(tmp[1], in1->arr + i, in2->arr + i, in3->arr + i,
+                            m, table1);
+        kernels->bw_ternary(out->arr + i, in4->arr + i, tmp[1], tmp[0], m,
+                            (unsigned char) ((jarr_ternary_in1
+                            & jarr_ternary_in2) | (~jarr_ternary_in1
+                            & jarr_ternary_in3)));
     }
 }
 
-void jarr_bw_not(struct jarr * const out, struct jarr const* const in)
+// counts the set bits, bits above length_bits in the last element are ignored
+
+jarr_length_t jarr_popcount(struct jarr const* const j)
 {
-    jarr_element_t* out_element = out->arr;
-    jarr_element_t const* in_element = in->arr;
-    while (in_element != in->limiter_element)
+    if (j->length_elements == (size_t) 0U)
     {
-        *out_element = ~(*in_element);
-        ++out_element;
-        ++in_element;
+        return 0;
     }
+    return jarr_simd_get_kernels()->popcount(j->arr, j->length_elements
+                                             - (size_t) 1)
+            + jarr_popcount_element(jarr_get_lev(j));
 }
 
-unsigned char jarr_add(struct jarr * const out, struct jarr const* const in1,
-                       struct jarr const* const in2, unsigned char carry)
+// counts the set bits in the section of length length starting at startbit
+
+jarr_length_t jarr_popcount_section(struct jarr const* const j,
+                                    jarr_length_t const length,
+                                    jarr_length_t const startbit)
+{
+    jarr_element_t const* element = j->arr + jarr_bitoei(startbit);
+    jarr_length_t const limiter_bit = startbit + length;
+    jarr_element_t const* const last_element = j->arr
+            + jarr_bitoei(limiter_bit - (jarr_length_t) 1);
+    jarr_element_t const first_mask = (jarr_element_t) ((jarr_element_t) - 1
+            << (startbit % jarr_element_length));
+    jarr_element_length_t const lme = limiter_bit % jarr_element_length;
+    jarr_element_t const last_mask = lme ? (jarr_element_t) ~((jarr_element_t)
+            - 1 << lme) : (jarr_element_t) - 1;
+
+    if (element == last_element)
+    {
+        return jarr_popcount_element(*element & first_mask & last_mask);
+    }
+
+    jarr_length_t count = jarr_popcount_element(*element & first_mask);
+    ++element;
+    count += jarr_simd_get_kernels()->popcount(element, (size_t) (last_element
+                                               - element));
+    return count + jarr_popcount_element(*last_element & last_mask);
+}
+
+// the index of the first set bit at or after bit, or length_bits if there is
+// none, whole elements of 0s are skipped with the find kernel
+
+jarr_length_t jarr_find_next_set(struct jarr const* const j,
+                                 jarr_length_t const bit)
+{
+    if (bit >= j->length_bits)
+    {
+        return j->length_bits;
+    }
+    size_t element = jarr_bitoei(bit);
+    jarr_element_t word = j->arr[element] & (jarr_element_t) ((jarr_element_t)
+            - 1 << (bit % jarr_element_length));
+    if (word == (jarr_element_t) 0)
+    {
+        ++element;
+        element += jarr_simd_get_kernels()->find(j->arr + element,
+                                                 j->length_elements - element,
+                                                 (jarr_element_t) 0);
+        if (element == j->length_elements)
+        {
+            return j->length_bits;
+        }
+        word = j->arr[element];
+    }
+    jarr_length_t const found = ((jarr_length_t) element * jarr_element_length)
+            + jarr_ctz_element(word);
+    // anything found above length_bits is in the unused part of the last
+    // element
+    return (found < j->length_bits) ? found : j->length_bits;
+}
+
+// the index of the first clear bit at or after bit, or length_bits if there is
+// none
+
+jarr_length_t jarr_find_next_clear(struct jarr const* const j,
+                                   jarr_length_t const bit)
 {
-    jarr_element_t* out_element = out->arr;
-    jarr_element_t const* in1_element = in1->arr;
-    jarr_element_t const* in2_element = in2->arr;
+    if (bit >= j->length_bits)
+    {
+        return j->length_bits;
+    }
+    size_t element = jarr_bitoei(bit);
+    jarr_element_t word = (jarr_element_t) ~j->arr[element]
+            & (jarr_element_t) ((jarr_element_t) - 1 << (bit
+            % jarr_element_length));
+    if (word == (jarr_element_t) 0)
+    {
+        ++element;
+        element += jarr_simd_get_kernels()->find(j->arr + element,
+                                                 j->length_elements - element,
+                                                 (jarr_element_t) - 1);
+        if (element == j->length_elements)
+        {
+            return j->length_bits;
+        }
+        word = (jarr_element_t) ~j->arr[element];
+    }
+    jarr_length_t const found = ((jarr_length_t) element * jarr_element_length)
+            + jarr_ctz_element(word);
+    return (found < j->length_bits) ? found : j->length_bits;
+}
 
-    while (in1_element < in1->last_element)
+// the index of the last set bit at or before bit, or length_bits if there is
+// none, a bit past the end searches from the end of the jarr
+
+jarr_length_t jarr_find_prev_set(struct jarr const* const j, jarr_length_t bit)
+{
+    if (bit >= j->length_bits)
+    {
+        bit = j->length_bits - (jarr_length_t) 1;
+    }
+    size_t element = jarr_bitoei(bit);
+    jarr_element_t word = j->arr[element] & (jarr_element_t) ((jarr_element_t)
+            - 1 >> (jarr_element_length - (jarr_element_length_t) 1
+            - (bit % jarr_element_length)));
+    if (word == (jarr_element_t) 0)
     {
-        *out_element = jarr_add_elements(&carry, *in1_element, *in2_element);
-        ++out_element;
-        ++in1_element;
-        ++in2_element;
+        size_t const found = jarr_simd_get_kernels()->rfind(j->arr, element,
+                                                            (jarr_element_t) 0);
+        if (found == element)
+        {
+            return j->length_bits;
+        }
+        element = found;
+        word = j->arr[element];
     }
+    return ((jarr_length_t) element * jarr_element_length)
+            + jarr_msb_element(word);
+}
+
+// 1 if two jarrs are the same length and hold the same bits, bits above
+// length_bits in the last element are ignored. The last elements are compared
+// first, then the rest with the mismatch kernel, which stops at the first
+// difference
+
+unsigned char jarr_equal(struct jarr const* const in1,
+                         struct jarr const* const in2)
+{
+    if (in1->length_bits != in2->length_bits)
+    {
+        return 0;
+    }
+    if (in1->length_elements == (size_t) 0U)
+    {
+        return 1;
+    }
+    size_t const n = in1->length_elements - (size_t) 1U;
+    return (jarr_get_lev(in1) == jarr_get_lev(in2))
+            && (jarr_simd_get_kernels()->mismatch(in1->arr, in2->arr, n) == n);
+}
+
+// 1 if every bit is clear/set, bits above length_bits in the last element are
+// ignored
+
+unsigned char jarr_is_zero(struct jarr const* const j)
+{
+    if (j->length_elements == (size_t) 0U)
+    {
+        return 1;
+    }
+    size_t const n = j->length_elements - (size_t) 1U;
+    return (jarr_get_lev(j) == (jarr_element_t) 0)
+            && (jarr_simd_get_kernels()->find(j->arr, n, (jarr_element_t) 0)
+            == n);
+}
+
+unsigned char jarr_is_all_ones(struct jarr const* const j)
+{
+    if (j->length_elements == (size_t) 0U)
+    {
+        return 1;
+    }
+    size_t const n = j->length_elements - (size_t) 1U;
+    return (jarr_get_lev(j) == j->mask)
+            && (jarr_simd_get_kernels()->find(j->arr, n, (jarr_element_t) - 1)
+            == n);
+}
+
+// compares two jarrs of the same length as unsigned numbers, returns -1, 0 or
+// 1 as in1 is less than, equal to or greater than in2. The most significant
+// elements are compared first and the first difference decides
+
+int jarr_compare(struct jarr const* const in1, struct jarr const* const in2)
+{
+    if (in1->length_elements == (size_t) 0U)
+    {
+        return 0;
+    }
+    jarr_element_t a = jarr_get_lev(in1);
+    jarr_element_t b = jarr_get_lev(in2);
+    if (a == b)
+    {
+        size_t const n = in1->length_elements - (size_t) 1U;
+        size_t const found = jarr_simd_get_kernels()->rmismatch(in1->arr,
+                                                                in2->arr, n);
+        if (found == n)
+        {
+            return 0;
+        }
+        a = in1->arr[found];
+        b = in2->arr[found];
+    }
+    return (a < b) ? -1 : 1;
+}
+
+// adds/subtracts n whole elements a 64 bit limb at a time, when the elements
+// are narrower than a limb this relies on a little endian byte order so that
+// a limb loaded from memory holds its elements in order of significance
+
+static unsigned char jarr_add_run(jarr_element_t * out,
+                                  jarr_element_t const* in1,
+                                  jarr_element_t const* in2, size_t n,
+                                  unsigned char carry)
+{
+#if jarr_limbs != 0
+    size_t const per_limb = sizeof (uint64_t) / sizeof (jarr_element_t);
+    while (n >= per_limb)
+    {
+        uint64_t a;
+        uint64_t b;
+        memcpy(&a, in1, sizeof (a));
+        memcpy(&b, in2, sizeof (b));
+        carry = jarr_addcarry_u64(carry, a, b, &a);
+        memcpy(out, &a, sizeof (a));
+        out += per_limb;
+        in1 += per_limb;
+        in2 += per_limb;
+        n -= per_limb;
+    }
+#endif
+    while (n != (size_t) 0U)
+    {
+        *out = jarr_add_elements(&carry, *in1, *in2);
+        ++out;
+        ++in1;
+        ++in2;
+        --n;
+    }
+    return carry;
+}
+
+static unsigned char jarr_sub_run(jarr_element_t * out,
+                                  jarr_element_t const* in1,
+                                  jarr_element_t const* in2, size_t n,
+                                  unsigned char borrow)
+{
+#if jarr_limbs != 0
+    size_t const per_limb = sizeof (uint64_t) / sizeof (jarr_element_t);
+    while (n >= per_limb)
+    {
+        uint64_t a;
+        uint64_t b;
+        memcpy(&a, in1, sizeof (a));
+        memcpy(&b, in2, sizeof (b));
+        borrow = jarr_subborrow_u64(borrow, a, b, &a);
+        memcpy(out, &a, sizeof (a));
+        out += per_limb;
+        in1 += per_limb;
+        in2 += per_limb;
+        n -= per_limb;
+    }
+#endif
+    while (n != (size_t) 0U)
+    {
+        *out = jarr_sub_elements(&borrow, *in1, *in2);
+        ++out;
+        ++in1;
+        ++in2;
+        --n;
+    }
+    return borrow;
+}
+
+unsigned char jarr_add(struct jarr * const out, struct jarr const* const in1,
+                       struct jarr const* const in2, unsigned char carry)
+{
+    size_t const last = in1->length_elements - (size_t) 1U;
+    carry = jarr_add_run(out->arr, in1->arr, in2->arr, last, carry);
 
     // evaluate the input possibly partial
     if (in1->bme == (jarr_element_length_t) 0U)
     {
-        *out_element = jarr_add_elements(&carry, *in1_element, *in2_element);
+        out->arr[last] = jarr_add_elements(&carry, in1->arr[last],
+                                           in2->arr[last]);
     }
     else
     {
-        *out_element = jarr_add_elements(&carry, jarr_get_lev(in1),
-                                         jarr_get_lev(in2));
+        out->arr[last] = jarr_add_elements(&carry, jarr_get_lev(in1),
+                                           jarr_get_lev(in2));
         carry = jarr_read(out, out->length_bits);
     }
     return carry;
 }
 
+unsigned char jarr_sub(struct jarr * const out, struct jarr const* const in1,
+                       struct jarr const* const in2, unsigned char borrow)
+{
+    size_t const last = in1->length_elements - (size_t) 1U;
+    borrow = jarr_sub_run(out->arr, in1->arr, in2->arr, last, borrow);
+
+    if (in1->bme == (jarr_element_length_t) 0U)
+    {
+        out->arr[last] = jarr_sub_elements(&borrow, in1->arr[last],
+                                           in2->arr[last]);
+    }
+    else
+    {
+        // a negative result sets every bit from length_bits up
+        out->arr[last] = jarr_sub_elements(&borrow, jarr_get_lev(in1),
+                                           jarr_get_lev(in2));
+        borrow = jarr_read(out, out->length_bits);
+    }
+    return borrow;
+}
+
+// the words above the elements shifted one at a time are funnel shifted from
+// the top down, so the elements below them still hold their input when they
+// are read, then the vacated elements are cleared
+
 void jarr_lshift(struct jarr * const out, struct jarr const* const in,
                  jarr_length_t const shift)
 {
-    size_t shift_elements = jarr_bitoei(shift);
-    jarr_element_length_t lshift_bits = shift % jarr_element_length;
-    jarr_element_t* from_element = in->last_element - shift_elements;
-    jarr_element_t* to_element = out->last_element;
 #if jarr_handle_0_shift != 0
-    if (lshift_bits != (jarr_element_length_t) 0)
+    if (shift == (jarr_length_t) 0)
     {
+        jarr_copy(out, in);
+        return;
+    }
 #endif
-        if (lshift_bits != 0)
-        {
-            jarr_element_length_t rshift_bits = jarr_element_length - lshift_bits;
-            while (from_element > in->arr)
-            {
-                *to_element = *from_element << lshift_bits;
-                --from_element;
-                *to_element |= *from_element >> rshift_bits;
-                --to_element;
-            }
-        }
-        else
+    size_t const shift_elements = jarr_bitoei(shift);
+    jarr_element_length_t const lshift_bits = shift % jarr_element_length;
+    // the elements from k up are done
+    size_t k = out->length_elements;
+#if jarr_word_sections != 0
+    {
+        // an output word at byte o starts at bit 8o - shift of the input, the
+        // lowest word starts at or above bit 0 of it
+        size_t const top = k * sizeof (jarr_element_t);
+        size_t const bottom = (size_t) ((shift + 7U) / 8U);
+        size_t const words = (top > bottom) ? (top - bottom) / 8U : 0;
+        size_t const o = top - (words * 8U);
+        jarr_length_t const from = ((jarr_length_t) o * 8U) - shift;
+        jarr_funnel((unsigned char*) out->arr + o, (unsigned char const*) in->arr
+                    + (from / 8U), words, (unsigned int) (from % 8U), 0);
+        k = o / sizeof (jarr_element_t);
+    }
+#endif
+    if (lshift_bits != 0)
+    {
+        jarr_element_length_t const rshift_bits = jarr_element_length
+                - lshift_bits;
+        while (k > shift_elements + (size_t) 1U)
         {
-            while (from_element > in->arr)
-            {
-                *to_element = *from_element;
-                --from_element;
-                --to_element;
-            }
+            --k;
+            out->arr[k] = (jarr_element_t) ((in->arr[k - shift_elements]
+                    << lshift_bits) | (in->arr[k - shift_elements - (size_t) 1U]
+                    >> rshift_bits));
         }
-        *to_element = *from_element << lshift_bits;
-        while (to_element > out->arr)
+        if (k > shift_elements)
         {
-            --to_element;
-            *to_element = (jarr_element_t) 0;
+            --k;
+            out->arr[k] = (jarr_element_t) (in->arr[0] << lshift_bits);
         }
-#if jarr_handle_0_shift != 0
     }
-    else
+    else if (k > shift_elements)
     {
-        jarr_copy(out, in);
+        memmove(out->arr + shift_elements, in->arr, (k - shift_elements)
+                * sizeof (jarr_element_t));
+        k = shift_elements;
     }
-#endif
+    memset(out->arr, 0, k * sizeof (jarr_element_t));
 }
 
+// the words below the elements shifted one at a time are funnel shifted from
+// the bottom up, stopping short of the last input element so that the bits
+// above length_bits in it are never shifted in
+
 void jarr_rshift(struct jarr * const out, struct jarr const* const in,
                  jarr_length_t const shift)
 {
+#if jarr_handle_0_shift != 0
+    if (shift == (jarr_length_t) 0)
+    {
+        jarr_copy(out, in);
+        return;
+    }
+#endif
     size_t shift_elements = jarr_bitoei(shift);
     jarr_element_length_t rshift_bits = shift % jarr_element_length;
     jarr_element_t* from_element = in->arr + shift_elements;
     jarr_element_t* to_element = out->arr;
-#if jarr_handle_0_shift != 0
-    if (rshift_bits != (jarr_element_length_t) 0)
+#if jarr_word_sections != 0
+    if (in->length_elements != (size_t) 0U)
     {
+        size_t const words = jarr_funnel_words(
+                out->length_elements * sizeof (jarr_element_t),
+                (size_t) (shift / 8U), (in->length_elements - (size_t) 1U)
+                * sizeof (jarr_element_t));
+        jarr_funnel((unsigned char*) out->arr, (unsigned char const*) in->arr
+                    + (shift / 8U), words, (unsigned int) (shift % 8U), 1);
+        from_element += words * jarr_word_elements;
+        to_element += words * jarr_word_elements;
+    }
 #endif
-        if (from_element < in->last_element)
+    if (from_element < in->last_element)
+    {
+        if (rshift_bits != 0)
         {
-            if (rshift_bits != 0)
-            {
-                jarr_element_length_t lshift_bits = jarr_element_length
-                        - rshift_bits;
-
-                while (from_element < in->last_element - 1)
-                {
-                    *to_element = *from_element >> rshift_bits;
-                    ++from_element;
-                    *to_element |= *from_element << lshift_bits;
-                    ++to_element;
-                }
+            jarr_element_length_t lshift_bits = jarr_element_length
+                    - rshift_bits;
 
+            while (from_element < in->last_element - 1)
+            {
                 *to_element = *from_element >> rshift_bits;
-                *to_element |= jarr_get_lev(in) << lshift_bits;
+                ++from_element;
+                *to_element |= *from_element << lshift_bits;
                 ++to_element;
             }
-            else
-            {
-                while (from_element < in->last_element)
-                {
-                    *to_element = *from_element;
-                    ++from_element;
-                    ++to_element;
-                }
-            }
+
+            *to_element = *from_element >> rshift_bits;
+            *to_element |= jarr_get_lev(in) << lshift_bits;
+            ++to_element;
         }
+        else
+        {
+            size_t const whole = (size_t) (in->last_element - from_element);
+            memmove(to_element, from_element, whole * sizeof (jarr_element_t));
+            to_element += whole;
+        }
+    }
 
-        *to_element = jarr_get_lev(in) >> rshift_bits;
-        while (to_element < out->last_element)
+    *to_element = jarr_get_lev(in) >> rshift_bits;
+    ++to_element;
+    memset(to_element, 0, (size_t) (out->limiter_element - to_element)
+           * sizeof (jarr_element_t));
+}
+
+// the bits jarr_rotl moves through its buffers at a time when rotating in
+// place
+
+#ifndef jarr_rotate_chunk
+#define jarr_rotate_chunk 4096U
+#endif
+
+// moves the section of length length at from to, which may overlap it
+
+static void jarr_move_section(struct jarr * const j, jarr_length_t const to,
+                              jarr_length_t const from,
+                              jarr_length_t const length,
+                              jarr_element_t * const buffer)
+{
+    jarr_length_t done;
+    for (done = 0; done < length; done += jarr_rotate_chunk)
+    {
+        jarr_length_t const n = (length - done < jarr_rotate_chunk)
+                ? length - done : jarr_rotate_chunk;
+        // moving down the chunks go from the bottom up, moving up from the top
+        // down, so no chunk is overwritten before it is read
+        jarr_length_t const offset = (to < from) ? done : length - done - n;
+        struct jarr chunk = jarr_init(buffer, n);
+        jarr_read_section(j, &chunk, from + offset);
+        jarr_write_section(j, &chunk, to + offset);
+    }
+}
+
+// swaps 2 sections of length length that do not overlap
+
+static void jarr_swap_sections(struct jarr * const j, jarr_length_t const a,
+                               jarr_length_t const b,
+                               jarr_length_t const length,
+                               jarr_element_t * const buffer_a,
+                               jarr_element_t * const buffer_b)
+{
+    jarr_length_t done;
+    for (done = 0; done < length; done += jarr_rotate_chunk)
+    {
+        jarr_length_t const n = (length - done < jarr_rotate_chunk)
+                ? length - done : jarr_rotate_chunk;
+        struct jarr chunk_a = jarr_init(buffer_a, n);
+        struct jarr chunk_b = jarr_init(buffer_b, n);
+        jarr_read_section(j, &chunk_a, a + done);
+        jarr_read_section(j, &chunk_b, b + done);
+        jarr_write_section(j, &chunk_b, a + done);
+        jarr_write_section(j, &chunk_a, b + done);
+    }
+}
+
+// rotates a jarr in place so the low bits, of length low, end up at the top.
+// While both parts are longer than a chunk the shorter is swapped into its
+// final place, which leaves a smaller rotation of the rest (Gries and Mills),
+// then the shorter part is held in a buffer while the longer is moved past it
+
+static void jarr_rotate_in_place(struct jarr * const j, jarr_length_t low)
+{
+    jarr_element_t buffer[2][jarr_rotate_chunk / jarr_element_length];
+    jarr_length_t start = 0;
+    jarr_length_t high = j->length_bits - low;
+    while ((low > jarr_rotate_chunk) && (high > jarr_rotate_chunk))
+    {
+        if (low <= high)
         {
-            ++to_element;
-            *to_element = (jarr_element_t) 0;
+            jarr_swap_sections(j, start, start + low, low, buffer[0],
+                               buffer[1]);
+            start += low;
+            high -= low;
         }
-#if jarr_handle_0_shift != 0
+        else
+        {
+            jarr_swap_sections(j, start + low - high, start + low, high,
+                               buffer[0], buffer[1]);
+            low -= high;
+        }
+    }
+    if ((low == (jarr_length_t) 0) || (high == (jarr_length_t) 0))
+    {
+        return;
+    }
+    if (low <= high)
+    {
+        struct jarr saved = jarr_init(buffer[0], low);
+        jarr_read_section(j, &saved, start);
+        jarr_move_section(j, start, start + low, high, buffer[1]);
+        jarr_write_section(j, &saved, start + high);
     }
     else
+    {
+        struct jarr saved = jarr_init(buffer[0], high);
+        jarr_read_section(j, &saved, start + low);
+        jarr_move_section(j, start + high, start, low, buffer[1]);
+        jarr_write_section(j, &saved, start);
+    }
+}
+
+// rotates the bits of a jarr left by shift, bits shifted out of the top come
+// back in at the bottom. Both jarrs must be the same length, out may be in
+
+void jarr_rotl(struct jarr * const out, struct jarr const* const in,
+               jarr_length_t shift)
+{
+    jarr_length_t const length = in->length_bits;
+    if (length == (jarr_length_t) 0)
+    {
+        return;
+    }
+    shift %= length;
+    if (out->arr == in->arr)
+    {
+        if (shift != (jarr_length_t) 0)
+        {
+            jarr_rotate_in_place(out, length - shift);
+        }
+        return;
+    }
+    if (shift == (jarr_length_t) 0)
     {
         jarr_copy(out, in);
+        return;
     }
-#endif
+    // the top of in goes to the bottom of out, then the rest of in goes above
+    // it, which keeps the bits of out below shift
+    struct jarr top = jarr_init(out->arr, shift);
+    jarr_read_section(in, &top, length - shift);
+    struct jarr const rest = jarr_init(in->arr, length - shift);
+    jarr_write_section(out, &rest, shift);
+}
+
+// rotates the bits of a jarr right by shift
+
+void jarr_rotr(struct jarr * const out, struct jarr const* const in,
+               jarr_length_t shift)
+{
+    jarr_length_t const length = in->length_bits;
+    if (length == (jarr_length_t) 0)
+    {
+        return;
+    }
+    shift %= length;
+    jarr_rotl(out, in, (shift != (jarr_length_t) 0) ? length - shift : 0);
 }
@@ -26,18 +26,39 @@ THE SOFTWARE.
 #define	JARR_H
 
 #include <limits.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #define jarr_handle_0_shift 0
 
+// the width in bits of a single element, may be overridden at compile time
+// with 8, 16, 32 or 64. Bit i is always bit (i % width) of element (i / width)
+// so on a little endian machine the memory layout of the bit array is the same
+// for every width
+
+#ifndef jarr_element_bits
+#define jarr_element_bits 64
+#endif
+
 typedef size_t jarr_length_t; // must serve as both the length in bits and a
 // bit index
-typedef unsigned char jarr_element_t; // serves as the type for the bit array,
+#if jarr_element_bits == 8
+typedef uint8_t jarr_element_t; // serves as the type for the bit array,
 // must be unsigned
+#elif jarr_element_bits == 16
+typedef uint16_t jarr_element_t;
+#elif jarr_element_bits == 32
+typedef uint32_t jarr_element_t;
+#elif jarr_element_bits == 64
+typedef uint64_t jarr_element_t;
+#else
+#error "jarr_element_bits must be 8, 16, 32 or 64"
+#endif
 typedef unsigned char jarr_element_length_t; // serves as the type for indexing
 // a bit inside an element
 
-const jarr_element_length_t jarr_element_length;
+// the length in bits of a single element
+#define jarr_element_length ((jarr_element_length_t) jarr_element_bits)
 
 struct jarr
 {
@@ -52,6 +73,31 @@ struct jarr
     jarr_element_length_t bme;
 };
 
+// the truth tables of the inputs of jarr_bw_ternary and jarr_bw_quaternary,
+// the table for any function of the inputs is the same function of these, e.g.
+// (jarr_quaternary_in1 & jarr_quaternary_in2)
+// | (jarr_quaternary_in3 & ~jarr_quaternary_in4)
+
+#define jarr_ternary_in1 0xf0U
+#define jarr_ternary_in2 0xccU
+#define jarr_ternary_in3 0xaaU
+#define jarr_quaternary_in1 0xff00U
+#define jarr_quaternary_in2 0xf0f0U
+#define jarr_quaternary_in3 0xccccU
+#define jarr_quaternary_in4 0xaaaaU
+
+// instruction sets the bulk operations can be executed with, in order of
+// preference
+
+enum jarr_isa
+{
+    jarr_isa_scalar,
+    jarr_isa_sse2,
+    jarr_isa_avx2,
+    jarr_isa_avx512,
+    jarr_isa_count
+};
+
 struct jarr jarr_init(jarr_element_t * const _arr,
                       jarr_length_t const _length_bits);
 void jarr_set_length(struct jarr * const j, jarr_length_t const _length_bits);
@@ -70,12 +116,48 @@ void jarr_bw_or(struct jarr * const out, struct jarr const* const in1,
 void jarr_bw_xor(struct jarr * const out, struct jarr const* const in1,
                  struct jarr const* const in2);
 void jarr_bw_not(struct jarr * const out, struct jarr const* const in);
+void jarr_bw_andnot(struct jarr * const out, struct jarr const* const in1,
+                    struct jarr const* const in2);
+void jarr_bw_ternary(struct jarr * const out, struct jarr const* const in1,
+                     struct jarr const* const in2,
+                     struct jarr const* const in3, unsigned char const table);
+void jarr_bw_quaternary(struct jarr * const out, struct jarr const* const in1,
+                        struct jarr const* const in2,
+                        struct jarr const* const in3,
+                        struct jarr const* const in4, uint16_t const table);
 unsigned char jarr_add(struct jarr * const out, struct jarr const* const in1,
                        struct jarr const* const in2, unsigned char carry);
+unsigned char jarr_sub(struct jarr * const out, struct jarr const* const in1,
+                       struct jarr const* const in2, unsigned char borrow);
+size_t jarr_mul_scratch_length(jarr_length_t const a_bits,
+                               jarr_length_t const b_bits);
+void jarr_mul(struct jarr * const out, struct jarr const* const a,
+              struct jarr const* const b, uint64_t * const scratch);
 void jarr_lshift(struct jarr * const out, struct jarr const* const in,
                  jarr_length_t const shift);
 void jarr_rshift(struct jarr * const out, struct jarr const* const in,
                  jarr_length_t const shift);
+void jarr_rotl(struct jarr * const out, struct jarr const* const in,
+               jarr_length_t shift);
+void jarr_rotr(struct jarr * const out, struct jarr const* const in,
+               jarr_length_t shift);
+jarr_length_t jarr_popcount(struct jarr const* const j);
+jarr_length_t jarr_popcount_section(struct jarr const* const j,
+                                    jarr_length_t const length,
+                                    jarr_length_t const startbit);
+jarr_length_t jarr_find_next_set(struct jarr const* const j,
+                                 jarr_length_t const bit);
+jarr_length_t jarr_find_next_clear(struct jarr const* const j,
+                                   jarr_length_t const bit);
+jarr_length_t jarr_find_prev_set(struct jarr const* const j,
+                                 jarr_length_t bit);
+unsigned char jarr_equal(struct jarr const* const in1,
+                         struct jarr const* const in2);
+unsigned char jarr_is_zero(struct jarr const* const j);
+unsigned char jarr_is_all_ones(struct jarr const* const j);
+int jarr_compare(struct jarr const* const in1, struct jarr const* const in2);
+enum jarr_isa jarr_get_isa(void);
+enum jarr_isa jarr_set_isa(enum jarr_isa isa);
 
 // bit index to element index
 
@@ -171,9 +253,9 @@ inline static jarr_element_t jarr_get_lev(struct jarr const* const j)
 inline static void jarr_copy(struct jarr * const out,
                              struct jarr const* const in)
 {
-    jarr_element_t* to_element = in->arr;
-    jarr_element_t const* from_element = out->arr;
-        
+    jarr_element_t* to_element = out->arr;
+    jarr_element_t const* from_element = in->arr;
+
     while (from_element != in->limiter_element)
     {
         *to_element = *from_element;
@@ -182,6 +264,108 @@ inline static void jarr_copy(struct jarr * const out,
     }
 }
 
+// counts the set bits in an element
+
+inline static jarr_element_length_t jarr_popcount_element(jarr_element_t e)
+{
+#if defined(__GNUC__)
+    return (jarr_element_length_t) __builtin_popcountll((unsigned long long) e);
+#else
+    jarr_element_length_t count = 0;
+    while (e != (jarr_element_t) 0)
+    {
+        e &= e - (jarr_element_t) 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// the index of the least significant set bit of an element, e must not be 0
+
+inline static jarr_element_length_t jarr_ctz_element(jarr_element_t e)
+{
+#if defined(__GNUC__)
+    return (jarr_element_length_t) __builtin_ctzll((unsigned long long) e);
+#else
+    jarr_element_length_t index = 0;
+    while ((e & (jarr_element_t) 1) == (jarr_element_t) 0)
+    {
+        e >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// the index of the most significant set bit of an element, e must not be 0
+
+inline static jarr_element_length_t jarr_msb_element(jarr_element_t e)
+{
+#if defined(__GNUC__)
+    return (jarr_element_length_t) ((sizeof (unsigned long long) * CHAR_BIT)
+            - 1U - (unsigned) __builtin_clzll((unsigned long long) e));
+#else
+    jarr_element_length_t index = 0;
+    while ((e >>= 1) != (jarr_element_t) 0)
+    {
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// iterates over the set bits of a jarr an element at a time, the remaining set
+// bits of the current element are kept in word
+
+struct jarr_iterator
+{
+    struct jarr const* j;
+    size_t element;
+    jarr_element_t word;
+};
+
+inline static struct jarr_iterator jarr_iterator_init(struct jarr const* const
+                                                      j)
+{
+    struct jarr_iterator it;
+    it.j = j;
+    it.element = 0;
+    it.word = (j->length_elements == (size_t) 1U) ? jarr_get_lev(j) : *j->arr;
+    return it;
+}
+
+// returns the index of the next set bit, or length_bits once there are none
+// left
+
+inline static jarr_length_t jarr_iterator_next(struct jarr_iterator * const it)
+{
+    if (it->word == (jarr_element_t) 0)
+    {
+        // skip to the next element containing a set bit
+        jarr_length_t const bit = jarr_find_next_set(it->j, (jarr_length_t)
+                (it->element + (size_t) 1U) * jarr_element_length);
+        if (bit == it->j->length_bits)
+        {
+            return bit;
+        }
+        it->element = jarr_bitoei(bit);
+        it->word = (it->element == it->j->length_elements - (size_t) 1U)
+                ? jarr_get_lev(it->j) : it->j->arr[it->element];
+    }
+    jarr_length_t const bit = ((jarr_length_t) it->element
+            * jarr_element_length) + jarr_ctz_element(it->word);
+    it->word &= it->word - (jarr_element_t) 1;
+    return bit;
+}
+
+// loops over the index of every set bit of j in ascending order, bit must be
+// a jarr_length_t and it a struct jarr_iterator
+
+#define jarr_foreach_set(bit, it, j) \
+    for ((it) = jarr_iterator_init(j), (bit) = jarr_iterator_next(&(it)); \
+         (bit) != (j)->length_bits; (bit) = jarr_iterator_next(&(it)))
+
 inline static jarr_element_t jarr_add_elements(unsigned char* const carry,
                                                jarr_element_t in1,
                                                jarr_element_t const in2)
@@ -194,4 +378,17 @@ inline static jarr_element_t jarr_add_elements(unsigned char* const carry,
     return in1;
 }
 
+inline static jarr_element_t jarr_sub_elements(unsigned char* const borrow,
+                                               jarr_element_t in1,
+                                               jarr_element_t const in2)
+{
+    unsigned char const next_borrow = ((in1 < in2) || ((in1 == in2)
+            && (*borrow != (unsigned char) 0))) ? (unsigned char) 1
+            : (unsigned char) 0;
+    in1 -= in2;
+    in1 -= *borrow;
+    *borrow = next_borrow;
+    return in1;
+}
+
 #endif
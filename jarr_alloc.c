@@ -0,0 +1,298 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+// posix_memalign
+#define _POSIX_C_SOURCE 200112L
+
+#include "jarr_alloc.h"
+
+#include <string.h>
+
+// allocates length bytes aligned to a cache line, NULL if there is not enough
+// memory
+
+static void* jarr_alloc_aligned(size_t const length)
+{
+    void* block;
+    if (posix_memalign(&block, jarr_alloc_align, length) != 0)
+    {
+        return NULL;
+    }
+    return block;
+}
+
+// a jarr from jarr_create is preceded by a cache line holding the number of
+// bytes allocated for its elements, a jarr without storage has none
+
+static size_t jarr_alloc_capacity(struct jarr const* const j)
+{
+    if (j->arr == NULL)
+    {
+        return 0;
+    }
+    size_t capacity;
+    memcpy(&capacity, (unsigned char const*) j->arr - jarr_alloc_align,
+           sizeof (capacity));
+    return capacity;
+}
+
+// allocates cleared, aligned storage for length bytes of elements
+
+static jarr_element_t* jarr_alloc_elements(size_t const length)
+{
+    unsigned char* const block = (unsigned char*) jarr_alloc_aligned(
+            jarr_alloc_align + length);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+    memcpy(block, &length, sizeof (length));
+    memset(block + jarr_alloc_align, 0, length);
+    return (jarr_element_t*) (block + jarr_alloc_align);
+}
+
+// creates a cleared jarr, arr is NULL if there is not enough memory
+
+struct jarr jarr_create(jarr_length_t const length_bits)
+{
+    return jarr_init(jarr_alloc_elements(jarr_alloc_length(length_bits)),
+                     length_bits);
+}
+
+// changes the length of a jarr from jarr_create, moving it if it needs more
+// storage. The bits past the old length are cleared. A jarr without storage,
+// after jarr_destroy or a failed jarr_create, gets new cleared storage.
+// Returns 0, or 1 if there is not enough memory, in which case the jarr is
+// unchanged
+
+unsigned char jarr_resize(struct jarr * const j,
+                          jarr_length_t const length_bits)
+{
+    size_t const length = jarr_alloc_length(length_bits);
+    if ((j->arr == NULL) || (length > jarr_alloc_capacity(j)))
+    {
+        jarr_element_t * const arr = jarr_alloc_elements(length);
+        if (arr == NULL)
+        {
+            return 1;
+        }
+        if ((j->arr != NULL) && (j->length_elements != (size_t) 0U))
+        {
+            memcpy(arr, j->arr, j->length_elements * sizeof (jarr_element_t));
+            arr[j->length_elements - (size_t) 1U] = jarr_get_lev(j);
+        }
+        jarr_destroy(j);
+        *j = jarr_init(arr, length_bits);
+        return 0;
+    }
+
+    // whatever was left past the shorter length is cleared, up to the end of the
+    // storage the longer one used, so the padding stays clear
+    struct jarr const shorter = jarr_init(j->arr, (length_bits < j->length_bits)
+                                          ? length_bits : j->length_bits);
+    size_t const used = (length_bits < j->length_bits)
+            ? jarr_alloc_length(j->length_bits) : length;
+    if (shorter.length_elements != (size_t) 0U)
+    {
+        *shorter.last_element = jarr_get_lev(&shorter);
+    }
+    memset(shorter.limiter_element, 0, used - (shorter.length_elements
+                                               * sizeof (jarr_element_t)));
+    jarr_set_length(j, length_bits);
+    return 0;
+}
+
+// frees the storage of a jarr from jarr_create
+
+void jarr_destroy(struct jarr * const j)
+{
+    if (j->arr != NULL)
+    {
+        free((unsigned char*) j->arr - jarr_alloc_align);
+    }
+    *j = jarr_init(NULL, 0);
+}
+
+void jarr_slab_init(struct jarr_slab * const s,
+                    jarr_length_t const length_bits, size_t const per_block)
+{
+    size_t const length = jarr_alloc_length(length_bits);
+    s->length_bits = length_bits;
+    // a free jarr holds a pointer
+    s->stride = (length != (size_t) 0U) ? length : jarr_alloc_align;
+    s->per_block = (per_block != (size_t) 0U) ? per_block : 1U;
+    s->blocks = NULL;
+    s->free = NULL;
+}
+
+// gets a cleared jarr, arr is NULL if there is not enough memory
+
+struct jarr jarr_slab_get(struct jarr_slab * const s)
+{
+    if (s->free == NULL)
+    {
+        // the first cache line of a block links it to the next
+        unsigned char * const block = (unsigned char*) jarr_alloc_aligned(
+                jarr_alloc_align + (s->stride * s->per_block));
+        if (block == NULL)
+        {
+            return jarr_init(NULL, s->length_bits);
+        }
+        memcpy(block, &s->blocks, sizeof (s->blocks));
+        s->blocks = block;
+        size_t i;
+        for (i = 0; i < s->per_block; ++i)
+        {
+            unsigned char * const buffer = block + jarr_alloc_align
+                    + (i * s->stride);
+            memcpy(buffer, &s->free, sizeof (s->free));
+            s->free = buffer;
+        }
+    }
+    unsigned char * const buffer = (unsigned char*) s->free;
+    memcpy(&s->free, buffer, sizeof (s->free));
+    memset(buffer, 0, s->stride);
+    return jarr_init((jarr_element_t*) buffer, s->length_bits);
+}
+
+// puts a jarr back to be reused
+
+void jarr_slab_put(struct jarr_slab * const s, struct jarr * const j)
+{
+    memcpy(j->arr, &s->free, sizeof (s->free));
+    s->free = j->arr;
+    *j = jarr_init(NULL, 0);
+}
+
+// frees every block, jarrs that were not put back are freed too
+
+void jarr_slab_destroy(struct jarr_slab * const s)
+{
+    while (s->blocks != NULL)
+    {
+        void* next;
+        memcpy(&next, s->blocks, sizeof (next));
+        free(s->blocks);
+        s->blocks = next;
+    }
+    s->free = NULL;
+}
+
+// an arena over length bytes of buffer, the start is rounded up to a cache line
+
+void jarr_arena_init(struct jarr_arena * const a, void* const buffer,
+                     size_t const length)
+{
+    size_t const skip = (size_t) ((jarr_alloc_align - ((uintptr_t) buffer
+            % jarr_alloc_align)) % jarr_alloc_align);
+    a->base = (unsigned char*) buffer + skip;
+    a->length = (length > skip) ? length - skip : 0;
+    a->used = 0;
+    a->block = NULL;
+}
+
+// an arena over length bytes allocated for it. Returns 0, or 1 if there is not
+// enough memory
+
+unsigned char jarr_arena_create(struct jarr_arena * const a,
+                                size_t const length)
+{
+    size_t const rounded = ((length + jarr_alloc_align - 1U)
+            / jarr_alloc_align) * jarr_alloc_align;
+    void* const block = jarr_alloc_aligned((rounded != (size_t) 0U) ? rounded
+                                           : jarr_alloc_align);
+    if (block == NULL)
+    {
+        return 1;
+    }
+    jarr_arena_init(a, block, rounded);
+    a->block = block;
+    return 0;
+}
+
+void jarr_arena_destroy(struct jarr_arena * const a)
+{
+    free(a->block);
+    jarr_arena_init(a, NULL, 0);
+}
+
+// gets length bytes starting on a cache line, NULL if the arena is too full
+
+void* jarr_arena_alloc(struct jarr_arena * const a, size_t const length)
+{
+    size_t const rounded = ((length + jarr_alloc_align - 1U)
+            / jarr_alloc_align) * jarr_alloc_align;
+    if ((rounded < length) || (rounded > a->length - a->used))
+    {
+        return NULL;
+    }
+    void* const p = a->base + a->used;
+    a->used += rounded;
+    return p;
+}
+
+// gets a temporary jarr, its bits are not cleared. arr is NULL if the arena is
+// too full
+
+struct jarr jarr_arena_get(struct jarr_arena * const a,
+                           jarr_length_t const length_bits)
+{
+    return jarr_init((jarr_element_t*) jarr_arena_alloc(
+            a, jarr_alloc_length(length_bits)), length_bits);
+}
+
+// jarr_mul with its scratch space got from arena, which is reset after, or
+// from the heap if arena is NULL. Returns 0, or 1 if there is not enough room,
+// in which case out is unchanged
+
+unsigned char jarr_mul_arena(struct jarr * const out,
+                             struct jarr const* const a,
+                             struct jarr const* const b,
+                             struct jarr_arena * const arena)
+{
+    size_t const length = jarr_mul_scratch_length(a->length_bits,
+                                                  b->length_bits)
+            * sizeof (uint64_t);
+    if (arena == NULL)
+    {
+        uint64_t * const scratch = (uint64_t*) malloc(
+                (length != (size_t) 0U) ? length : 1U);
+        if (scratch == NULL)
+        {
+            return 1;
+        }
+        jarr_mul(out, a, b, scratch);
+        free(scratch);
+        return 0;
+    }
+    size_t const mark = jarr_arena_mark(arena);
+    uint64_t * const scratch = (uint64_t*) jarr_arena_alloc(arena, length);
+    if (scratch == NULL)
+    {
+        return 1;
+    }
+    jarr_mul(out, a, b, scratch);
+    jarr_arena_reset(arena, mark);
+    return 0;
+}
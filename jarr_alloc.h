@@ -0,0 +1,104 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_ALLOC_H
+#define	JARR_ALLOC_H
+
+#include "jarr.h"
+
+// jarrs that own their storage. The elements start on a cache line boundary
+// and run on to the next one, the padding past length_bits is cleared, so
+// kernels may read whole vectors past the end of a jarr
+
+#define jarr_alloc_align 64U
+
+// same sized jarrs carved out of blocks allocated per_block at a time. Put back
+// jarrs are kept on a free list for the next get, so once enough have been made
+// none are allocated. Not thread safe
+
+struct jarr_slab
+{
+    jarr_length_t length_bits;
+    // the bytes between the starts of neighbouring jarrs in a block
+    size_t stride;
+    size_t per_block;
+    // each block and each free jarr starts with a pointer to the next
+    void* blocks;
+    void* free;
+};
+
+// temporaries bumped off the front of one buffer. A mark taken before a step
+// is reset to afterwards, handing back everything got since in one go
+
+struct jarr_arena
+{
+    unsigned char* base;
+    size_t length;
+    size_t used;
+    // the storage from jarr_arena_create, NULL if the caller provided it
+    void* block;
+};
+
+struct jarr jarr_create(jarr_length_t const length_bits);
+unsigned char jarr_resize(struct jarr * const j,
+                          jarr_length_t const length_bits);
+void jarr_destroy(struct jarr * const j);
+void jarr_slab_init(struct jarr_slab * const s,
+                    jarr_length_t const length_bits, size_t const per_block);
+struct jarr jarr_slab_get(struct jarr_slab * const s);
+void jarr_slab_put(struct jarr_slab * const s, struct jarr * const j);
+void jarr_slab_destroy(struct jarr_slab * const s);
+void jarr_arena_init(struct jarr_arena * const a, void* const buffer,
+                     size_t const length);
+unsigned char jarr_arena_create(struct jarr_arena * const a,
+                                size_t const length);
+void jarr_arena_destroy(struct jarr_arena * const a);
+void* jarr_arena_alloc(struct jarr_arena * const a, size_t const length);
+struct jarr jarr_arena_get(struct jarr_arena * const a,
+                           jarr_length_t const length_bits);
+unsigned char jarr_mul_arena(struct jarr * const out,
+                             struct jarr const* const a,
+                             struct jarr const* const b,
+                             struct jarr_arena * const arena);
+
+// the bytes of aligned storage for a jarr of length bit_length
+
+inline static size_t jarr_alloc_length(jarr_length_t const bit_length)
+{
+    return (((jarr_bltoel(bit_length) * sizeof (jarr_element_t))
+            + jarr_alloc_align - 1U) / jarr_alloc_align) * jarr_alloc_align;
+}
+
+inline static size_t jarr_arena_mark(struct jarr_arena const* const a)
+{
+    return a->used;
+}
+
+inline static void jarr_arena_reset(struct jarr_arena * const a,
+                                    size_t const mark)
+{
+    a->used = mark;
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr_atomic.h"
+
+// the section ops update each element they touch atomically, bits outside the
+// section are never written, but the section as a whole does not change in one
+// step. The elements wholly inside it are stored to, which is the same as
+// or-ing or and-ing in all of their bits
+
+void jarr_atomic_set_section(struct jarr * const j, jarr_length_t const length,
+                             jarr_length_t const startbit,
+                             memory_order const order)
+{
+    jarr_atomic_element_t* element = jarr_atomic_element(j, startbit);
+    jarr_length_t const limiter_bit = startbit + length;
+    jarr_atomic_element_t* const last_element = jarr_atomic_element(
+            j, limiter_bit - (jarr_length_t) 1);
+    // a release or acquire order cannot be used on a store
+    memory_order const store_order = (order == memory_order_seq_cst)
+            ? memory_order_seq_cst : (order == memory_order_relaxed)
+            ? memory_order_relaxed : memory_order_release;
+    jarr_element_t const first_mask = (jarr_element_t) ((jarr_element_t) - 1
+            << (startbit % jarr_element_length));
+    jarr_element_length_t const lme = limiter_bit % jarr_element_length;
+    jarr_element_t const last_mask = lme ? (jarr_element_t) ~((jarr_element_t)
+            - 1 << lme) : (jarr_element_t) - 1;
+
+    if (element == last_element)
+    {
+        atomic_fetch_or_explicit(element, first_mask & last_mask, order);
+        return;
+    }
+    atomic_fetch_or_explicit(element, first_mask, order);
+    ++element;
+    while (element < last_element)
+    {
+        atomic_store_explicit(element, (jarr_element_t) - 1, store_order);
+        ++element;
+    }
+    atomic_fetch_or_explicit(element, last_mask, order);
+}
+
+void jarr_atomic_clear_section(struct jarr * const j,
+                               jarr_length_t const length,
+                               jarr_length_t const startbit,
+                               memory_order const order)
+{
+    jarr_atomic_element_t* element = jarr_atomic_element(j, startbit);
+    jarr_length_t const limiter_bit = startbit + length;
+    jarr_atomic_element_t* const last_element = jarr_atomic_element(
+            j, limiter_bit - (jarr_length_t) 1);
+    memory_order const store_order = (order == memory_order_seq_cst)
+            ? memory_order_seq_cst : (order == memory_order_relaxed)
+            ? memory_order_relaxed : memory_order_release;
+    jarr_element_t const first_mask = (jarr_element_t) ((jarr_element_t) - 1
+            << (startbit % jarr_element_length));
+    jarr_element_length_t const lme = limiter_bit % jarr_element_length;
+    jarr_element_t const last_mask = lme ? (jarr_element_t) ~((jarr_element_t)
+            - 1 << lme) : (jarr_element_t) - 1;
+
+    if (element == last_element)
+    {
+        atomic_fetch_and_explicit(element, (jarr_element_t) ~(first_mask
+                                  & last_mask), order);
+        return;
+    }
+    atomic_fetch_and_explicit(element, (jarr_element_t) ~first_mask, order);
+    ++element;
+    while (element < last_element)
+    {
+        atomic_store_explicit(element, 0, store_order);
+        ++element;
+    }
+    atomic_fetch_and_explicit(element, (jarr_element_t) ~last_mask, order);
+}
@@ -0,0 +1,130 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_ATOMIC_H
+#define	JARR_ATOMIC_H
+
+#include "jarr.h"
+
+#include <stdatomic.h>
+
+// bit operations that are safe while other threads operate on the same jarr,
+// each is one atomic read-modify-write of the element holding the bit. order is
+// the memory order of that access: memory_order_relaxed when the bits are all
+// that is shared, memory_order_release on a set that publishes data written
+// before it and memory_order_acquire on the test that reads it, or
+// memory_order_seq_cst for a single total order over every atomic operation.
+// Mixing these with the plain operations on the same elements is a data race
+
+typedef _Atomic jarr_element_t jarr_atomic_element_t;
+
+void jarr_atomic_set_section(struct jarr * const j, jarr_length_t const length,
+                             jarr_length_t const startbit,
+                             memory_order const order);
+void jarr_atomic_clear_section(struct jarr * const j,
+                               jarr_length_t const length,
+                               jarr_length_t const startbit,
+                               memory_order const order);
+
+// the element holding a bit
+
+inline static jarr_atomic_element_t* jarr_atomic_element(
+        struct jarr const* const j, jarr_length_t const bit)
+{
+    return (jarr_atomic_element_t*) (j->arr + (bit / jarr_element_length));
+}
+
+inline static jarr_element_t jarr_atomic_mask(jarr_length_t const bit)
+{
+    return (jarr_element_t) ((jarr_element_t) 1 << (bit
+            % jarr_element_length));
+}
+
+// sets a bit
+
+inline static void jarr_atomic_set(struct jarr * const j,
+                                   jarr_length_t const bit,
+                                   memory_order const order)
+{
+    atomic_fetch_or_explicit(jarr_atomic_element(j, bit), jarr_atomic_mask(bit),
+                             order);
+}
+
+// clears a bit
+
+inline static void jarr_atomic_clear(struct jarr * const j,
+                                     jarr_length_t const bit,
+                                     memory_order const order)
+{
+    atomic_fetch_and_explicit(jarr_atomic_element(j, bit),
+                              (jarr_element_t) ~jarr_atomic_mask(bit), order);
+}
+
+// toggles a bit
+
+inline static void jarr_atomic_toggle(struct jarr * const j,
+                                      jarr_length_t const bit,
+                                      memory_order const order)
+{
+    atomic_fetch_xor_explicit(jarr_atomic_element(j, bit),
+                              jarr_atomic_mask(bit), order);
+}
+
+// reads a bit, order must not be a release order
+
+inline static unsigned char jarr_atomic_read(struct jarr const* const j,
+                                             jarr_length_t const bit,
+                                             memory_order const order)
+{
+    return ((atomic_load_explicit(jarr_atomic_element(j, bit), order)
+            & jarr_atomic_mask(bit)) != (jarr_element_t) 0) ? (unsigned char) 1
+            : (unsigned char) 0;
+}
+
+// sets a bit, returning what it was before. Of the threads setting a clear bit
+// at the same time exactly one sees 0
+
+inline static unsigned char jarr_test_and_set(struct jarr * const j,
+                                              jarr_length_t const bit,
+                                              memory_order const order)
+{
+    jarr_element_t const mask = jarr_atomic_mask(bit);
+    return ((atomic_fetch_or_explicit(jarr_atomic_element(j, bit), mask, order)
+            & mask) != (jarr_element_t) 0) ? (unsigned char) 1
+            : (unsigned char) 0;
+}
+
+// clears a bit, returning what it was before
+
+inline static unsigned char jarr_test_and_clear(struct jarr * const j,
+                                                jarr_length_t const bit,
+                                                memory_order const order)
+{
+    jarr_element_t const mask = jarr_atomic_mask(bit);
+    return ((atomic_fetch_and_explicit(jarr_atomic_element(j, bit),
+                                       (jarr_element_t) ~mask, order) & mask)
+            != (jarr_element_t) 0) ? (unsigned char) 1 : (unsigned char) 0;
+}
+
+#endif
@@ -0,0 +1,184 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr_batch.h"
+
+#include <string.h>
+
+// how many indices ahead elements are prefetched, enough to keep several cache
+// misses in flight
+
+#ifndef jarr_batch_distance
+#define jarr_batch_distance 16U
+#endif
+
+#if defined(__GNUC__)
+#define jarr_prefetch(p, write) __builtin_prefetch((p), (write), 0)
+#else
+#define jarr_prefetch(p, write) ((void) (p))
+#endif
+
+enum jarr_batch_op
+{
+    jarr_batch_op_set,
+    jarr_batch_op_clear,
+    jarr_batch_op_toggle
+};
+
+// applies op to the bits at indices, merging each run of indices in the same
+// element. Runs of the same index cancel for a toggle, as they should
+
+inline static void jarr_batch_apply(struct jarr * const j,
+                                    jarr_length_t const* const indices,
+                                    size_t const n,
+                                    enum jarr_batch_op const op)
+{
+    size_t i = 0;
+    while (i < n)
+    {
+        size_t const e = jarr_bitoei(indices[i]);
+        jarr_element_t mask = 0;
+        do
+        {
+            if (i + jarr_batch_distance < n)
+            {
+                jarr_prefetch(j->arr + jarr_bitoei(indices[i
+                              + jarr_batch_distance]), 1);
+            }
+            jarr_element_t const bit = (jarr_element_t) ((jarr_element_t) 1
+                    << (indices[i] % jarr_element_length));
+            mask = (op == jarr_batch_op_toggle) ? (jarr_element_t) (mask ^ bit)
+                    : (jarr_element_t) (mask | bit);
+            ++i;
+        }
+        while ((i < n) && (jarr_bitoei(indices[i]) == e));
+
+        switch (op)
+        {
+        case jarr_batch_op_set:
+            j->arr[e] |= mask;
+            break;
+        case jarr_batch_op_clear:
+            j->arr[e] &= (jarr_element_t) ~mask;
+            break;
+        default:
+            j->arr[e] ^= mask;
+            break;
+        }
+    }
+}
+
+// sets the bits at n indices
+
+void jarr_set_many(struct jarr * const j, jarr_length_t const* const indices,
+                   size_t const n)
+{
+    jarr_batch_apply(j, indices, n, jarr_batch_op_set);
+}
+
+// clears the bits at n indices
+
+void jarr_clear_many(struct jarr * const j,
+                     jarr_length_t const* const indices, size_t const n)
+{
+    jarr_batch_apply(j, indices, n, jarr_batch_op_clear);
+}
+
+// toggles the bits at n indices, an index given twice is toggled twice
+
+void jarr_toggle_many(struct jarr * const j,
+                      jarr_length_t const* const indices, size_t const n)
+{
+    jarr_batch_apply(j, indices, n, jarr_batch_op_toggle);
+}
+
+// reads the bits at n indices into out, 1 byte per bit
+
+void jarr_read_many(struct jarr const* const j,
+                    jarr_length_t const* const indices, size_t const n,
+                    unsigned char * const out)
+{
+    size_t i;
+    for (i = 0; i < n; ++i)
+    {
+        if (i + jarr_batch_distance < n)
+        {
+            jarr_prefetch(j->arr + jarr_bitoei(indices[i
+                          + jarr_batch_distance]), 0);
+        }
+        out[i] = (unsigned char) ((j->arr[jarr_bitoei(indices[i])]
+                >> (indices[i] % jarr_element_length)) & 1U);
+    }
+}
+
+// sorts n indices below length_bits into ascending order, scratch must hold n
+// indices. A least significant digit radix sort, a byte at a time, with only as
+// many passes as length_bits has bytes
+
+void jarr_sort_indices(jarr_length_t * const indices,
+                       jarr_length_t * const scratch, size_t const n,
+                       jarr_length_t const length_bits)
+{
+    if (n == (size_t) 0U)
+    {
+        return;
+    }
+    jarr_length_t* from = indices;
+    jarr_length_t* to = scratch;
+    unsigned int shift;
+    for (shift = 0; (shift < sizeof (jarr_length_t) * CHAR_BIT)
+            && (((length_bits - (jarr_length_t) 1) >> shift)
+                != (jarr_length_t) 0); shift += 8U)
+    {
+        size_t count[256] = {0};
+        size_t i;
+        for (i = 0; i < n; ++i)
+        {
+            ++count[(from[i] >> shift) & 0xffU];
+        }
+        // a pass that would leave every index where it is is skipped
+        if (count[(from[0] >> shift) & 0xffU] == n)
+        {
+            continue;
+        }
+        size_t offset = 0;
+        for (i = 0; i < 256U; ++i)
+        {
+            size_t const c = count[i];
+            count[i] = offset;
+            offset += c;
+        }
+        for (i = 0; i < n; ++i)
+        {
+            to[count[(from[i] >> shift) & 0xffU]++] = from[i];
+        }
+        jarr_length_t * const swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != indices)
+    {
+        memcpy(indices, from, n * sizeof (*indices));
+    }
+}
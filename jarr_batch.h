@@ -0,0 +1,50 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_BATCH_H
+#define	JARR_BATCH_H
+
+#include "jarr.h"
+
+// bit operations on many indices at once. The element of each index some way
+// ahead is prefetched so that the cache misses of a batch overlap, and runs of
+// indices in the same element are merged into one read-modify-write. Sorting
+// a batch first with jarr_sort_indices puts indices in the same cache line
+// together, which helps most when a batch is dense or the jarr is much larger
+// than the cache
+
+void jarr_set_many(struct jarr * const j, jarr_length_t const* const indices,
+                   size_t const n);
+void jarr_clear_many(struct jarr * const j,
+                     jarr_length_t const* const indices, size_t const n);
+void jarr_toggle_many(struct jarr * const j,
+                      jarr_length_t const* const indices, size_t const n);
+void jarr_read_many(struct jarr const* const j,
+                    jarr_length_t const* const indices, size_t const n,
+                    unsigned char * const out);
+void jarr_sort_indices(jarr_length_t * const indices,
+                       jarr_length_t * const scratch, size_t const n,
+                       jarr_length_t const length_bits);
+
+#endif
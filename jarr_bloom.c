@@ -0,0 +1,408 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr_bloom.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define jarr_bloom_simd 1
+#else
+#define jarr_bloom_simd 0
+#endif
+
+// how many hashes ahead blocks are prefetched by the batch operations
+
+#ifndef jarr_bloom_batch_distance
+#define jarr_bloom_batch_distance 16U
+#endif
+
+#if defined(__GNUC__)
+#define jarr_bloom_prefetch(p, write) __builtin_prefetch((p), (write), 0)
+#else
+#define jarr_bloom_prefetch(p, write) ((void) (p))
+#endif
+
+#define jarr_bloom_magic "jarrblom"
+#define jarr_bloom_byte_order 0x01020304U
+
+// the layout of the first jarr_bloom_header_size bytes of a serialised filter
+
+struct jarr_bloom_header_layout
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t blocks;
+    uint32_t element_bits;
+    uint32_t k;
+    unsigned char padding[32];
+};
+
+// the multiplier for each 32 bit word of a block, odd so that every one maps
+// the low 32 bits of a hash to a different permutation of them
+
+static uint32_t const jarr_bloom_salt[jarr_bloom_max_k] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+    0x9e3779b1U, 0x85ebca77U, 0xc2b2ae3dU, 0x27d4eb2fU,
+    0x165667b1U, 0xd3a2646dU, 0xfd7046c5U, 0xb55a4f09U
+};
+
+// the bit set in word i of the block for hash h
+
+#define jarr_bloom_bit(h, i) (((h) * jarr_bloom_salt[(i)]) >> 27U)
+
+// the first of the k words a hash sets a bit in
+
+#define jarr_bloom_word(hash) ((unsigned int) ((hash) >> 32U) \
+        & (jarr_bloom_max_k - 1U))
+
+// the block a hash goes to, from its high bits without a division where there
+// is a 128 bit multiply
+
+static size_t jarr_bloom_block(struct jarr_bloom const* const b,
+                               uint64_t const hash)
+{
+#if defined(__SIZEOF_INT128__)
+    return (size_t) (((unsigned __int128) hash * b->blocks) >> 64U);
+#else
+    return (size_t) (hash % (uint64_t) b->blocks);
+#endif
+}
+
+static unsigned char* jarr_bloom_block_bytes(struct jarr_bloom const* const b,
+                                             size_t const block)
+{
+    return (unsigned char*) b->bits.arr + (block * (jarr_bloom_block_bits
+            / CHAR_BIT));
+}
+
+static void jarr_bloom_insert_scalar(struct jarr_bloom * const b,
+                                     uint64_t const hash)
+{
+    jarr_length_t const base = (jarr_length_t) jarr_bloom_block(b, hash)
+            * jarr_bloom_block_bits;
+    uint32_t const h = (uint32_t) hash;
+    unsigned int i;
+    for (i = 0; i < b->k; ++i)
+    {
+        unsigned int const w = (jarr_bloom_word(hash) + i)
+                & (jarr_bloom_max_k - 1U);
+        jarr_set(&b->bits, base + (32U * w) + jarr_bloom_bit(h, w));
+    }
+}
+
+static unsigned char jarr_bloom_query_scalar(struct jarr_bloom const* const b,
+                                             uint64_t const hash)
+{
+    jarr_length_t const base = (jarr_length_t) jarr_bloom_block(b, hash)
+            * jarr_bloom_block_bits;
+    uint32_t const h = (uint32_t) hash;
+    unsigned int i;
+    for (i = 0; i < b->k; ++i)
+    {
+        unsigned int const w = (jarr_bloom_word(hash) + i)
+                & (jarr_bloom_max_k - 1U);
+        if (jarr_read(&b->bits, base + (32U * w) + jarr_bloom_bit(h, w)) == 0)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#if jarr_bloom_simd != 0
+
+// x86 is little endian, so bit t of 32 bit word i of a block is bit 32i + t of
+// the block as a jarr whatever the element width. Every word is worked on at
+// once, a variable shift putting each word's bit in place, then the words
+// without a bit are masked off. sse2 has neither the 32 bit multiply nor the
+// variable shift so uses the scalar code
+
+// the word numbers, a word has a bit if its distance on from the first word
+// mod 16 is less than k
+
+static uint32_t const jarr_bloom_words[jarr_bloom_max_k] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+};
+
+// the bits for words 8 * half to 8 * half + 7
+
+__attribute__((target("avx2"))) static inline __m256i jarr_bloom_bits_avx2(
+        uint64_t const hash, unsigned int const k, size_t const half)
+{
+    __m256i const salt = _mm256_loadu_si256((__m256i const*) (jarr_bloom_salt
+            + (8U * half)));
+    __m256i const words = _mm256_loadu_si256((__m256i const*)
+            (jarr_bloom_words + (8U * half)));
+    __m256i const distance = _mm256_and_si256(_mm256_sub_epi32(words,
+            _mm256_set1_epi32((int) jarr_bloom_word(hash))),
+            _mm256_set1_epi32((int) jarr_bloom_max_k - 1));
+    __m256i const lanes = _mm256_cmpgt_epi32(_mm256_set1_epi32((int) k),
+                                             distance);
+    __m256i const shift = _mm256_srli_epi32(_mm256_mullo_epi32(
+            _mm256_set1_epi32((int) (uint32_t) hash), salt), 27);
+    return _mm256_and_si256(_mm256_sllv_epi32(_mm256_set1_epi32(1), shift),
+                            lanes);
+}
+
+__attribute__((target("avx2"))) static inline void jarr_bloom_insert_avx2(
+        struct jarr_bloom * const b, uint64_t const hash)
+{
+    unsigned char * const block = jarr_bloom_block_bytes(b,
+            jarr_bloom_block(b, hash));
+    size_t half;
+    for (half = 0; half < 2U; ++half)
+    {
+        __m256i * const p = (__m256i*) (block + (32U * half));
+        _mm256_storeu_si256(p, _mm256_or_si256(_mm256_loadu_si256(p),
+                jarr_bloom_bits_avx2(hash, b->k, half)));
+    }
+}
+
+__attribute__((target("avx2"))) static inline unsigned char
+jarr_bloom_query_avx2(struct jarr_bloom const* const b, uint64_t const hash)
+{
+    unsigned char const* const block = jarr_bloom_block_bytes(b,
+            jarr_bloom_block(b, hash));
+    // testc is 1 when every bit set in the second is set in the first
+    return (unsigned char) (_mm256_testc_si256(_mm256_loadu_si256(
+            (__m256i const*) block), jarr_bloom_bits_avx2(hash, b->k,
+            0)) & _mm256_testc_si256(_mm256_loadu_si256((__m256i const*)
+            (block + 32U)), jarr_bloom_bits_avx2(hash, b->k, 1U)));
+}
+
+__attribute__((target("avx512f"))) static inline __m512i jarr_bloom_bits_avx512(
+        uint64_t const hash, unsigned int const k)
+{
+    // the k words from the first, wrapping round
+    unsigned int const first = jarr_bloom_word(hash);
+    unsigned int const run = (1U << k) - 1U;
+    __mmask16 const lanes = (__mmask16) ((run << first) | (run
+            >> (jarr_bloom_max_k - first)));
+    __m512i const salt = _mm512_loadu_si512((void const*) jarr_bloom_salt);
+    __m512i const shift = _mm512_srli_epi32(_mm512_mullo_epi32(
+            _mm512_set1_epi32((int) (uint32_t) hash), salt), 27);
+    return _mm512_maskz_sllv_epi32(lanes, _mm512_set1_epi32(1), shift);
+}
+
+__attribute__((target("avx512f"))) static inline void jarr_bloom_insert_avx512(
+        struct jarr_bloom * const b, uint64_t const hash)
+{
+    unsigned char * const block = jarr_bloom_block_bytes(b,
+            jarr_bloom_block(b, hash));
+    _mm512_storeu_si512((void*) block, _mm512_or_si512(_mm512_loadu_si512(
+            (void const*) block), jarr_bloom_bits_avx512(hash,
+            b->k)));
+}
+
+__attribute__((target("avx512f"))) static inline unsigned char
+jarr_bloom_query_avx512(struct jarr_bloom const* const b, uint64_t const hash)
+{
+    unsigned char const* const block = jarr_bloom_block_bytes(b,
+            jarr_bloom_block(b, hash));
+    __m512i const bits = jarr_bloom_bits_avx512(hash, b->k);
+    return _mm512_cmpneq_epi32_mask(_mm512_and_si512(_mm512_loadu_si512(
+            (void const*) block), bits), bits) == 0;
+}
+
+#define jarr_bloom_target_avx2 __attribute__((target("avx2")))
+#define jarr_bloom_target_avx512 __attribute__((target("avx512f")))
+
+#endif
+
+#define jarr_bloom_target_scalar
+
+// the batch loops, one per instruction set so that the single key code is
+// inlined into them, each prefetches the block of the hash
+// jarr_bloom_batch_distance on
+
+#define jarr_bloom_batch(isa)                                                  \
+jarr_bloom_target_##isa static void jarr_bloom_insert_many_##isa(              \
+        struct jarr_bloom * const b, uint64_t const* const hashes,             \
+        size_t const n)                                                        \
+{                                                                              \
+    size_t i;                                                                  \
+    for (i = 0; i < n; ++i)                                                    \
+    {                                                                          \
+        if (i + jarr_bloom_batch_distance < n)                                 \
+        {                                                                      \
+            jarr_bloom_prefetch(jarr_bloom_block_bytes(b, jarr_bloom_block(b,  \
+                    hashes[i + jarr_bloom_batch_distance])), 1);               \
+        }                                                                      \
+        jarr_bloom_insert_##isa(b, hashes[i]);                                 \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+jarr_bloom_target_##isa static size_t jarr_bloom_query_many_##isa(             \
+        struct jarr_bloom const* const b, uint64_t const* const hashes,        \
+        size_t const n, unsigned char * const out)                             \
+{                                                                              \
+    size_t count = 0;                                                          \
+    size_t i;                                                                  \
+    for (i = 0; i < n; ++i)                                                    \
+    {                                                                          \
+        if (i + jarr_bloom_batch_distance < n)                                 \
+        {                                                                      \
+            jarr_bloom_prefetch(jarr_bloom_block_bytes(b, jarr_bloom_block(b,  \
+                    hashes[i + jarr_bloom_batch_distance])), 0);               \
+        }                                                                      \
+        unsigned char const found = jarr_bloom_query_##isa(b, hashes[i]);      \
+        if (out != NULL)                                                       \
+        {                                                                      \
+            out[i] = found;                                                    \
+        }                                                                      \
+        count += found;                                                        \
+    }                                                                          \
+    return count;                                                              \
+}
+
+jarr_bloom_batch(scalar)
+#if jarr_bloom_simd != 0
+jarr_bloom_batch(avx2)
+jarr_bloom_batch(avx512)
+#endif
+
+// an empty filter of blocks blocks using arr, which must hold
+// jarr_bloom_length(blocks) elements and is best 64 byte aligned so that each
+// block is a cache line
+
+struct jarr_bloom jarr_bloom_init(jarr_element_t * const _arr,
+                                  size_t const _blocks,
+                                  unsigned int const _k)
+{
+    struct jarr_bloom b;
+    b.bits = jarr_init(_arr, (jarr_length_t) _blocks * jarr_bloom_block_bits);
+    b.blocks = _blocks;
+    b.k = _k;
+    jarr_clear_all(&b.bits);
+    return b;
+}
+
+void jarr_bloom_insert(struct jarr_bloom * const b, uint64_t const hash)
+{
+    jarr_bloom_insert_many(b, &hash, 1U);
+}
+
+// 0 if the key was never inserted, 1 if it probably was
+
+unsigned char jarr_bloom_query(struct jarr_bloom const* const b,
+                               uint64_t const hash)
+{
+    return (unsigned char) jarr_bloom_query_many(b, &hash, 1U, NULL);
+}
+
+void jarr_bloom_insert_many(struct jarr_bloom * const b,
+                            uint64_t const* const hashes, size_t const n)
+{
+    switch (jarr_get_isa())
+    {
+#if jarr_bloom_simd != 0
+    case jarr_isa_avx512:
+        jarr_bloom_insert_many_avx512(b, hashes, n);
+        break;
+    case jarr_isa_avx2:
+        jarr_bloom_insert_many_avx2(b, hashes, n);
+        break;
+#endif
+    default:
+        jarr_bloom_insert_many_scalar(b, hashes, n);
+        break;
+    }
+}
+
+// queries n hashes, putting the result for each in out if it is not NULL, and
+// returns how many were probably inserted
+
+size_t jarr_bloom_query_many(struct jarr_bloom const* const b,
+                             uint64_t const* const hashes, size_t const n,
+                             unsigned char * const out)
+{
+    switch (jarr_get_isa())
+    {
+#if jarr_bloom_simd != 0
+    case jarr_isa_avx512:
+        return jarr_bloom_query_many_avx512(b, hashes, n, out);
+    case jarr_isa_avx2:
+        return jarr_bloom_query_many_avx2(b, hashes, n, out);
+#endif
+    default:
+        return jarr_bloom_query_many_scalar(b, hashes, n, out);
+    }
+}
+
+// writes the jarr_bloom_header_size byte header of a serialised filter, the
+// elements of b->bits follow it
+
+void jarr_bloom_header(struct jarr_bloom const* const b,
+                       unsigned char * const header)
+{
+    struct jarr_bloom_header_layout h;
+    memset(&h, 0, sizeof (h));
+    memcpy(h.magic, jarr_bloom_magic, sizeof (h.magic));
+    h.version = jarr_bloom_version;
+    h.byte_order = jarr_bloom_byte_order;
+    h.blocks = (uint64_t) b->blocks;
+    h.element_bits = jarr_element_bits;
+    h.k = b->k;
+    memcpy(header, &h, sizeof (h));
+}
+
+// makes b the filter serialised in buffer, using the elements in place. The
+// elements must be aligned for jarr_element_t. Returns 1 if buffer does not
+// hold a filter this build can use
+
+unsigned char jarr_bloom_load(struct jarr_bloom * const b, void * const buffer,
+                              size_t const length)
+{
+    struct jarr_bloom_header_layout h;
+    if (length < jarr_bloom_header_size)
+    {
+        return 1;
+    }
+    memcpy(&h, buffer, sizeof (h));
+    if ((memcmp(h.magic, jarr_bloom_magic, sizeof (h.magic)) != 0)
+        || (h.version != jarr_bloom_version)
+        || (h.byte_order != jarr_bloom_byte_order)
+        || (h.element_bits != jarr_element_bits)
+        || (h.k == 0U) || (h.k > jarr_bloom_max_k) || (h.blocks == 0U)
+        || (h.blocks > (length - jarr_bloom_header_size)
+            / (jarr_bloom_block_bits / CHAR_BIT)))
+    {
+        return 1;
+    }
+    unsigned char * const elements = (unsigned char*) buffer
+            + jarr_bloom_header_size;
+    if (((uintptr_t) elements % sizeof (jarr_element_t)) != 0U)
+    {
+        return 1;
+    }
+    b->blocks = (size_t) h.blocks;
+    b->k = h.k;
+    b->bits = jarr_init((jarr_element_t*) elements, (jarr_length_t) b->blocks
+                        * jarr_bloom_block_bits);
+    return 0;
+}
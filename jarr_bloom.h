@@ -0,0 +1,100 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_BLOOM_H
+#define	JARR_BLOOM_H
+
+#include "jarr.h"
+
+#include <stdint.h>
+
+// a blocked bloom filter, the bits are split into blocks of 512, one cache
+// line, and every key sets k bits all in one block so a lookup touches one
+// line. The block is picked by the high bits of the key's 64 bit hash. Of the
+// 16 32 bit words of the block k in a row, wrapping round, starting at a word
+// picked by 4 more bits of the hash, get a bit each. The low 32 bits of the
+// hash are multiplied by a different odd constant for each word and the top 5
+// bits of the product pick the bit set in that word. The hashes must be well
+// mixed already.
+//
+// The bits are kept in a jarr. In memory a serialised filter is a
+// jarr_bloom_header_size byte header followed by the jarr's elements, so a
+// filter can be loaded from a buffer or a mapped file without copying
+
+#define jarr_bloom_block_bits 512U
+#define jarr_bloom_max_k 16U
+#define jarr_bloom_header_size 64U
+#define jarr_bloom_version 1U
+
+struct jarr_bloom
+{
+    struct jarr bits;
+    size_t blocks;
+    // bits set per key, 1 to jarr_bloom_max_k
+    unsigned int k;
+};
+
+struct jarr_bloom jarr_bloom_init(jarr_element_t * const _arr,
+                                  size_t const _blocks,
+                                  unsigned int const _k);
+void jarr_bloom_insert(struct jarr_bloom * const b, uint64_t const hash);
+unsigned char jarr_bloom_query(struct jarr_bloom const* const b,
+                               uint64_t const hash);
+void jarr_bloom_insert_many(struct jarr_bloom * const b,
+                            uint64_t const* const hashes, size_t const n);
+size_t jarr_bloom_query_many(struct jarr_bloom const* const b,
+                             uint64_t const* const hashes, size_t const n,
+                             unsigned char * const out);
+void jarr_bloom_header(struct jarr_bloom const* const b,
+                       unsigned char * const header);
+unsigned char jarr_bloom_load(struct jarr_bloom * const b, void * const buffer,
+                              size_t const length);
+
+// elements needed for a filter of blocks blocks
+
+inline static size_t jarr_bloom_length(size_t const blocks)
+{
+    return blocks * (jarr_bloom_block_bits / jarr_element_length);
+}
+
+// blocks needed for keys keys at bits_per_key bits each, at least 1
+
+inline static size_t jarr_bloom_blocks(size_t const keys,
+                                       size_t const bits_per_key)
+{
+    size_t const blocks = ((keys * bits_per_key) + jarr_bloom_block_bits - 1U)
+            / jarr_bloom_block_bits;
+    return (blocks == (size_t) 0U) ? (size_t) 1U : blocks;
+}
+
+// bytes of a serialised filter, the header and the elements
+
+inline static size_t jarr_bloom_serialised_length(struct jarr_bloom const*
+                                                  const b)
+{
+    return jarr_bloom_header_size + (jarr_bloom_length(b->blocks)
+            * sizeof (jarr_element_t));
+}
+
+#endif
@@ -0,0 +1,440 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr_ewah.h"
+
+#include <string.h>
+
+#define jarr_ewah_running_shift 1U
+#define jarr_ewah_literal_shift 33U
+
+enum jarr_ewah_op
+{
+    jarr_ewah_op_and,
+    jarr_ewah_op_or,
+    jarr_ewah_op_xor,
+    jarr_ewah_op_andnot
+};
+
+#define jarr_ewah_apply(op, a, b) \
+    (((op) == jarr_ewah_op_and) ? ((a) & (b)) \
+    : ((op) == jarr_ewah_op_or) ? ((a) | (b)) \
+    : ((op) == jarr_ewah_op_xor) ? ((a) ^ (b)) : ((a) & ~(b)))
+
+// appends to a compressed stream, once it runs out of space fail is set and
+// everything else is dropped
+
+struct jarr_ewah_writer
+{
+    struct jarr_ewah* e;
+    // the index of the last marker, or capacity_words before the first
+    size_t marker;
+    unsigned char fail;
+};
+
+// walks a compressed stream, the clean words of the current marker come
+// before its literals
+
+struct jarr_ewah_reader
+{
+    uint64_t const* word;
+    uint64_t const* end;
+    // 0 or all ones
+    uint64_t running_bit;
+    uint64_t running_length;
+    uint64_t literal_length;
+};
+
+struct jarr_ewah jarr_ewah_init(uint64_t * const _words,
+                                size_t const _capacity_words,
+                                jarr_length_t const _length_bits)
+{
+    struct jarr_ewah e = {
+        .words = _words,
+        .length_words = 0,
+        .capacity_words = _capacity_words,
+        .length_bits = _length_bits
+    };
+    return e;
+}
+
+static struct jarr_ewah_writer jarr_ewah_writer_init(struct jarr_ewah * const e,
+                                                     jarr_length_t const
+                                                     length_bits)
+{
+    struct jarr_ewah_writer w = {
+        .e = e,
+        .marker = e->capacity_words,
+        .fail = 0
+    };
+    e->length_words = 0;
+    e->length_bits = length_bits;
+    return w;
+}
+
+static void jarr_ewah_new_marker(struct jarr_ewah_writer * const w)
+{
+    if (w->e->length_words == w->e->capacity_words)
+    {
+        w->fail = 1;
+        return;
+    }
+    w->marker = w->e->length_words;
+    w->e->words[w->e->length_words++] = 0;
+}
+
+// appends count clean words of bit, 0 or 1
+
+static void jarr_ewah_put_clean(struct jarr_ewah_writer * const w,
+                                uint64_t const bit, uint64_t count)
+{
+    while ((count != 0U) && (w->fail == 0))
+    {
+        if (w->marker != w->e->capacity_words)
+        {
+            uint64_t * const marker = w->e->words + w->marker;
+            uint64_t const running = (*marker >> jarr_ewah_running_shift)
+                    & jarr_ewah_running_max;
+            // clean words can only join a marker with no literals yet
+            if (((*marker >> jarr_ewah_literal_shift) == 0U)
+                && ((running == 0U) || ((*marker & 1U) == bit))
+                && (running != jarr_ewah_running_max))
+            {
+                uint64_t const add = (count < jarr_ewah_running_max - running)
+                        ? count : jarr_ewah_running_max - running;
+                *marker = (*marker & ~((uint64_t) jarr_ewah_running_max
+                        << jarr_ewah_running_shift)) | bit | ((running + add)
+                        << jarr_ewah_running_shift);
+                count -= add;
+                continue;
+            }
+        }
+        jarr_ewah_new_marker(w);
+    }
+}
+
+// appends count words each xored with flip, clean ones are run length encoded
+
+static void jarr_ewah_put_literals(struct jarr_ewah_writer * const w,
+                                   uint64_t const* const words,
+                                   uint64_t const count, uint64_t const flip)
+{
+    uint64_t i;
+    for (i = 0; (i < count) && (w->fail == 0); ++i)
+    {
+        uint64_t const word = words[i] ^ flip;
+        if ((word == 0U) || (word == (uint64_t) - 1))
+        {
+            jarr_ewah_put_clean(w, word & 1U, 1U);
+            continue;
+        }
+        if ((w->marker == w->e->capacity_words)
+            || ((w->e->words[w->marker] >> jarr_ewah_literal_shift)
+                == jarr_ewah_literal_max))
+        {
+            jarr_ewah_new_marker(w);
+        }
+        if ((w->fail != 0) || (w->e->length_words == w->e->capacity_words))
+        {
+            w->fail = 1;
+            return;
+        }
+        w->e->words[w->marker] += (uint64_t) 1 << jarr_ewah_literal_shift;
+        w->e->words[w->e->length_words++] = word;
+    }
+}
+
+static struct jarr_ewah_reader jarr_ewah_reader_init(struct jarr_ewah const*
+                                                     const e)
+{
+    struct jarr_ewah_reader r = {
+        .word = e->words,
+        .end = e->words + e->length_words,
+        .running_bit = 0,
+        .running_length = 0,
+        .literal_length = 0
+    };
+    return r;
+}
+
+// moves on to the next marker with any words once the current one is used
+// up, returns 0 at the end of the stream
+
+static unsigned char jarr_ewah_reader_load(struct jarr_ewah_reader * const r)
+{
+    while ((r->running_length == 0U) && (r->literal_length == 0U))
+    {
+        if (r->word == r->end)
+        {
+            return 0;
+        }
+        uint64_t const marker = *r->word++;
+        r->running_bit = (uint64_t) 0 - (marker & 1U);
+        r->running_length = (marker >> jarr_ewah_running_shift)
+                & jarr_ewah_running_max;
+        r->literal_length = marker >> jarr_ewah_literal_shift;
+    }
+    return 1;
+}
+
+// copies, or discards if w is NULL, the next count words of a stream, each
+// xored with flip
+
+static void jarr_ewah_reader_copy(struct jarr_ewah_reader * const r,
+                                  struct jarr_ewah_writer * const w,
+                                  uint64_t count, uint64_t const flip)
+{
+    while ((count != 0U) && (jarr_ewah_reader_load(r) != 0))
+    {
+        uint64_t n;
+        if (r->running_length != 0U)
+        {
+            n = (count < r->running_length) ? count : r->running_length;
+            if (w != NULL)
+            {
+                jarr_ewah_put_clean(w, (r->running_bit ^ flip) & 1U, n);
+            }
+            r->running_length -= n;
+        }
+        else
+        {
+            n = (count < r->literal_length) ? count : r->literal_length;
+            if (w != NULL)
+            {
+                jarr_ewah_put_literals(w, r->word, n, flip);
+            }
+            r->word += n;
+            r->literal_length -= n;
+        }
+        count -= n;
+    }
+}
+
+// out = in1 op in2. Where either input has a run of clean words the result
+// over the run is clean or a copy of the other input, possibly negated, so
+// runs cost the same as a single word
+
+static unsigned char jarr_ewah_op(struct jarr_ewah * const out,
+                                  struct jarr_ewah const* const in1,
+                                  struct jarr_ewah const* const in2,
+                                  enum jarr_ewah_op const op)
+{
+    struct jarr_ewah_writer w = jarr_ewah_writer_init(out, in1->length_bits);
+    struct jarr_ewah_reader r1 = jarr_ewah_reader_init(in1);
+    struct jarr_ewah_reader r2 = jarr_ewah_reader_init(in2);
+
+    while ((w.fail == 0) && (jarr_ewah_reader_load(&r1) != 0)
+           && (jarr_ewah_reader_load(&r2) != 0))
+    {
+        if ((r1.running_length != 0U) || (r2.running_length != 0U))
+        {
+            // the longer run leads, the other input is consumed alongside it
+            struct jarr_ewah_reader * const lead = (r1.running_length
+                    >= r2.running_length) ? &r1 : &r2;
+            struct jarr_ewah_reader * const other = (lead == &r1) ? &r2 : &r1;
+            uint64_t const count = lead->running_length;
+            uint64_t const c = lead->running_bit;
+            lead->running_length = 0;
+
+            // what the op does to a word of the other input, given the
+            // results for 0 and all ones
+            uint64_t const zero = (lead == &r1) ? jarr_ewah_apply(op, c,
+                    (uint64_t) 0) : jarr_ewah_apply(op, (uint64_t) 0, c);
+            uint64_t const ones = (lead == &r1) ? jarr_ewah_apply(op, c,
+                    (uint64_t) - 1) : jarr_ewah_apply(op, (uint64_t) - 1, c);
+            if (zero == ones)
+            {
+                jarr_ewah_put_clean(&w, zero & 1U, count);
+                jarr_ewah_reader_copy(other, NULL, count, 0);
+            }
+            else
+            {
+                jarr_ewah_reader_copy(other, &w, count, zero);
+            }
+        }
+        else
+        {
+            uint64_t const count = (r1.literal_length < r2.literal_length)
+                    ? r1.literal_length : r2.literal_length;
+            uint64_t i;
+            for (i = 0; i < count; ++i)
+            {
+                uint64_t const word = jarr_ewah_apply(op, r1.word[i],
+                                                      r2.word[i]);
+                jarr_ewah_put_literals(&w, &word, 1U, 0);
+            }
+            r1.word += count;
+            r2.word += count;
+            r1.literal_length -= count;
+            r2.literal_length -= count;
+        }
+    }
+    return w.fail;
+}
+
+// the number of elements in each 64 bit word
+
+#define jarr_ewah_word_elements (64U / jarr_element_bits)
+
+// compresses a jarr, returns 0 or 1 if out ran out of space
+
+unsigned char jarr_ewah_from_jarr(struct jarr_ewah * const out,
+                                  struct jarr const* const in)
+{
+    struct jarr_ewah_writer w = jarr_ewah_writer_init(out, in->length_bits);
+    size_t const length = (size_t) ((in->length_bits + 63U) / 64U);
+    size_t i;
+    for (i = 0; (i < length) && (w.fail == 0); ++i)
+    {
+        size_t const first = i * jarr_ewah_word_elements;
+        size_t end = first + jarr_ewah_word_elements;
+        if (end > in->length_elements)
+        {
+            end = in->length_elements;
+        }
+        uint64_t word = 0;
+        size_t e;
+        for (e = first; e < end; ++e)
+        {
+            // the last element is masked so the stream is clear above
+            // length_bits
+            uint64_t const v = (e == in->length_elements - (size_t) 1U)
+                    ? (uint64_t) jarr_get_lev(in) : (uint64_t) in->arr[e];
+            word |= v << ((e - first) * jarr_element_bits);
+        }
+        jarr_ewah_put_literals(&w, &word, 1U, 0);
+    }
+    return w.fail;
+}
+
+// writes count copies of a word from word index to a jarr
+
+static void jarr_ewah_fill(struct jarr * const out, size_t const index,
+                           uint64_t const count, unsigned char const value)
+{
+    size_t const first = index * jarr_ewah_word_elements;
+    size_t end = first + ((size_t) count * jarr_ewah_word_elements);
+    if (end > out->length_elements)
+    {
+        end = out->length_elements;
+    }
+    memset(out->arr + first, value, (end - first) * sizeof (jarr_element_t));
+}
+
+// decompresses into a jarr of the same length
+
+void jarr_ewah_to_jarr(struct jarr * const out,
+                       struct jarr_ewah const* const in)
+{
+    struct jarr_ewah_reader r = jarr_ewah_reader_init(in);
+    size_t index = 0;
+    while (jarr_ewah_reader_load(&r) != 0)
+    {
+        jarr_ewah_fill(out, index, r.running_length, (r.running_bit != 0U)
+                       ? (unsigned char) 0xffU : (unsigned char) 0U);
+        index += (size_t) r.running_length;
+        r.running_length = 0;
+
+        uint64_t i;
+        for (i = 0; i < r.literal_length; ++i, ++index)
+        {
+            size_t const first = index * jarr_ewah_word_elements;
+            size_t end = first + jarr_ewah_word_elements;
+            if (end > out->length_elements)
+            {
+                end = out->length_elements;
+            }
+            size_t e;
+            for (e = first; e < end; ++e)
+            {
+                out->arr[e] = (jarr_element_t) (r.word[i] >> ((e - first)
+                        * jarr_element_bits));
+            }
+        }
+        r.word += r.literal_length;
+        r.literal_length = 0;
+    }
+}
+
+unsigned char jarr_ewah_and(struct jarr_ewah * const out,
+                            struct jarr_ewah const* const in1,
+                            struct jarr_ewah const* const in2)
+{
+    return jarr_ewah_op(out, in1, in2, jarr_ewah_op_and);
+}
+
+unsigned char jarr_ewah_or(struct jarr_ewah * const out,
+                           struct jarr_ewah const* const in1,
+                           struct jarr_ewah const* const in2)
+{
+    return jarr_ewah_op(out, in1, in2, jarr_ewah_op_or);
+}
+
+unsigned char jarr_ewah_xor(struct jarr_ewah * const out,
+                            struct jarr_ewah const* const in1,
+                            struct jarr_ewah const* const in2)
+{
+    return jarr_ewah_op(out, in1, in2, jarr_ewah_op_xor);
+}
+
+unsigned char jarr_ewah_andnot(struct jarr_ewah * const out,
+                               struct jarr_ewah const* const in1,
+                               struct jarr_ewah const* const in2)
+{
+    return jarr_ewah_op(out, in1, in2, jarr_ewah_op_andnot);
+}
+
+// out = ~in, the bits above length_bits in the last word are cleared again
+
+unsigned char jarr_ewah_not(struct jarr_ewah * const out,
+                            struct jarr_ewah const* const in)
+{
+    struct jarr_ewah_writer w = jarr_ewah_writer_init(out, in->length_bits);
+    struct jarr_ewah_reader r = jarr_ewah_reader_init(in);
+    jarr_ewah_reader_copy(&r, &w, (uint64_t) - 1, (uint64_t) - 1);
+    unsigned int const spare = (unsigned int) (in->length_bits % 64U);
+    if ((w.fail != 0) || (spare == 0U) || (out->length_words == (size_t) 0U))
+    {
+        return w.fail;
+    }
+
+    uint64_t const mask = ((uint64_t) 1 << spare) - 1U;
+    uint64_t * const marker = out->words + w.marker;
+    if ((*marker >> jarr_ewah_literal_shift) != 0U)
+    {
+        out->words[out->length_words - (size_t) 1U] &= mask;
+    }
+    else if ((*marker & 1U) != 0U)
+    {
+        // the last clean word of the run becomes a literal
+        if (out->length_words == out->capacity_words)
+        {
+            return 1;
+        }
+        *marker = (*marker - ((uint64_t) 1 << jarr_ewah_running_shift))
+                + ((uint64_t) 1 << jarr_ewah_literal_shift);
+        out->words[out->length_words++] = mask;
+    }
+    return 0;
+}
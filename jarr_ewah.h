@@ -0,0 +1,83 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_EWAH_H
+#define	JARR_EWAH_H
+
+#include "jarr.h"
+
+#include <stdint.h>
+
+// a jarr compressed with enhanced word aligned hybrid run length encoding.
+// The bits are taken 64 at a time, and the stream is a series of marker words
+// each followed by some literal words. A marker holds a run of clean words,
+// all 0 or all 1, then gives the number of literal words that come after it.
+// Bit 0 of a marker is the bit of its clean words, bits 1 to 32 the number of
+// clean words and bits 33 to 63 the number of literal words
+
+#define jarr_ewah_running_max 0xffffffffU
+#define jarr_ewah_literal_max 0x7fffffffU
+
+struct jarr_ewah
+{
+    uint64_t* words;
+    size_t length_words;
+    size_t capacity_words;
+    jarr_length_t length_bits;
+};
+
+struct jarr_ewah jarr_ewah_init(uint64_t * const _words,
+                                size_t const _capacity_words,
+                                jarr_length_t const _length_bits);
+unsigned char jarr_ewah_from_jarr(struct jarr_ewah * const out,
+                                  struct jarr const* const in);
+void jarr_ewah_to_jarr(struct jarr * const out,
+                       struct jarr_ewah const* const in);
+unsigned char jarr_ewah_and(struct jarr_ewah * const out,
+                            struct jarr_ewah const* const in1,
+                            struct jarr_ewah const* const in2);
+unsigned char jarr_ewah_or(struct jarr_ewah * const out,
+                           struct jarr_ewah const* const in1,
+                           struct jarr_ewah const* const in2);
+unsigned char jarr_ewah_xor(struct jarr_ewah * const out,
+                            struct jarr_ewah const* const in1,
+                            struct jarr_ewah const* const in2);
+unsigned char jarr_ewah_andnot(struct jarr_ewah * const out,
+                               struct jarr_ewah const* const in1,
+                               struct jarr_ewah const* const in2);
+unsigned char jarr_ewah_not(struct jarr_ewah * const out,
+                            struct jarr_ewah const* const in);
+
+// the number of words always enough for a compressed jarr of length
+// bit_length. Every marker but the first holds at least one clean word or
+// follows a full marker's worth of literals, the last word of a jarr whose
+// length is not a multiple of 64 can cost one more
+
+inline static size_t jarr_ewah_words_length(jarr_length_t const bit_length)
+{
+    size_t const words = (size_t) ((bit_length + 63U) / 64U);
+    return words + (words / jarr_ewah_literal_max) + (size_t) 2U;
+}
+
+#endif
@@ -0,0 +1,613 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+// ftruncate, pread and pwrite
+#define _POSIX_C_SOURCE 200809L
+
+#include "jarr_file.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define jarr_file_magic "jarrfile"
+// written in the host's byte order, read back differently on a host with
+// another
+#define jarr_file_byte_order 0x01020304U
+
+// the layout of the first jarr_file_header_size bytes of a file
+
+struct jarr_file_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t length_bits;
+    uint32_t element_bits;
+    uint32_t reserved;
+    uint64_t checksum;
+    unsigned char padding[24];
+};
+
+// the 64 bit finaliser from MurmurHash3, maps 0 to 0
+
+inline static uint64_t jarr_checksum_mix(uint64_t h)
+{
+    h ^= h >> 33U;
+    h *= 0xff51afd7ed558ccdU;
+    h ^= h >> 33U;
+    h *= 0xc4ceb9fe1a85ec53U;
+    h ^= h >> 33U;
+    return h;
+}
+
+// the checksum of the elements taken 64 bits at a time, the bits above
+// length_bits are ignored. Each word is mixed and weighted by its position
+// and the results summed, so words of 0 add nothing and a file of 0s can be
+// created without writing it. The sum can be built up a part at a time,
+// word_index is the index of the first word of j in the whole jarr
+
+uint64_t jarr_checksum_sum(struct jarr const* const j,
+                           uint64_t const word_index)
+{
+    uint64_t sum = 0;
+    uint64_t index = word_index;
+    if (j->length_elements != (size_t) 0U)
+    {
+        unsigned char const* const bytes = (unsigned char const*) j->arr;
+        size_t const length = (j->length_elements - (size_t) 1U)
+                * sizeof (jarr_element_t);
+        size_t i;
+        for (i = 0; i + 8U <= length; i += 8U, ++index)
+        {
+            uint64_t word;
+            memcpy(&word, bytes + i, sizeof (word));
+            sum += jarr_checksum_mix(word) * ((2U * index) + 1U);
+        }
+        // the rest, then the masked last element
+        unsigned char tail[16] = {0};
+        jarr_element_t const lev = jarr_get_lev(j);
+        memcpy(tail, bytes + i, length - i);
+        memcpy(tail + (length - i), &lev, sizeof (lev));
+        size_t const tail_length = (length - i) + sizeof (lev);
+        for (i = 0; i < tail_length; i += 8U, ++index)
+        {
+            uint64_t word;
+            memcpy(&word, tail + i, sizeof (word));
+            sum += jarr_checksum_mix(word) * ((2U * index) + 1U);
+        }
+    }
+    return sum;
+}
+
+// the checksum of a jarr of length length_bits from the sum of its parts
+
+uint64_t jarr_checksum_finish(uint64_t const sum,
+                              jarr_length_t const length_bits)
+{
+    return jarr_checksum_mix(sum ^ (uint64_t) length_bits);
+}
+
+uint64_t jarr_checksum(struct jarr const* const j)
+{
+    return jarr_checksum_finish(jarr_checksum_sum(j, 0), j->length_bits);
+}
+
+// writes all of a buffer, retrying short writes and writes interrupted by a
+// signal
+
+static enum jarr_file_status jarr_file_write_all(int const fd,
+                                                 void const* const buffer,
+                                                 size_t length)
+{
+    unsigned char const* bytes = (unsigned char const*) buffer;
+    while (length != (size_t) 0U)
+    {
+        ssize_t const written = write(fd, bytes, length);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return jarr_file_error_io;
+        }
+        bytes += written;
+        length -= (size_t) written;
+    }
+    return jarr_file_ok;
+}
+
+static struct jarr_file_header jarr_file_header_init(jarr_length_t const
+                                                     length_bits,
+                                                     uint64_t const checksum)
+{
+    struct jarr_file_header h;
+    memset(&h, 0, sizeof (h));
+    memcpy(h.magic, jarr_file_magic, sizeof (h.magic));
+    h.version = jarr_file_version;
+    h.byte_order = jarr_file_byte_order;
+    h.length_bits = (uint64_t) length_bits;
+    h.element_bits = jarr_element_bits;
+    h.checksum = checksum;
+    return h;
+}
+
+// checks a header can be used by this build and that the file is long
+// enough for it
+
+static enum jarr_file_status jarr_file_check_header(struct jarr_file_header
+                                                    const* const h,
+                                                    size_t const file_size)
+{
+    if ((memcmp(h->magic, jarr_file_magic, sizeof (h->magic)) != 0)
+        || (h->version != jarr_file_version)
+        || ((uint64_t) (jarr_length_t) h->length_bits != h->length_bits))
+    {
+        return jarr_file_error_format;
+    }
+    if (h->byte_order != jarr_file_byte_order)
+    {
+        return jarr_file_error_byte_order;
+    }
+    if (h->element_bits != jarr_element_bits)
+    {
+        return jarr_file_error_width;
+    }
+    if ((file_size - jarr_file_header_size) / sizeof (jarr_element_t)
+        < jarr_bltoel((jarr_length_t) h->length_bits))
+    {
+        return jarr_file_error_format;
+    }
+    return jarr_file_ok;
+}
+
+// writes a jarr to a new file or over an existing one
+
+enum jarr_file_status jarr_write_file(char const* const path,
+                                      struct jarr const* const j)
+{
+    struct jarr_file_header const h = jarr_file_header_init(j->length_bits,
+                                                            jarr_checksum(j));
+    int const fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0)
+    {
+        return jarr_file_error_io;
+    }
+    enum jarr_file_status status = jarr_file_write_all(fd, &h, sizeof (h));
+    if ((status == jarr_file_ok) && (j->length_elements != (size_t) 0U))
+    {
+        jarr_element_t const lev = jarr_get_lev(j);
+        status = jarr_file_write_all(fd, j->arr, (j->length_elements
+                                     - (size_t) 1U) * sizeof (jarr_element_t));
+        if (status == jarr_file_ok)
+        {
+            status = jarr_file_write_all(fd, &lev, sizeof (lev));
+        }
+    }
+    if ((close(fd) != 0) && (status == jarr_file_ok))
+    {
+        status = jarr_file_error_io;
+    }
+    return status;
+}
+
+// creates a file holding a cleared jarr without writing the elements and
+// opens it with flags, on most file systems it takes no space until it is
+// written to
+
+static enum jarr_file_status jarr_file_create(char const* const path,
+                                              jarr_length_t const length_bits,
+                                              int const flags, int * const fd)
+{
+    struct jarr_file_header const h = jarr_file_header_init(length_bits,
+            jarr_checksum_finish(0, length_bits));
+    *fd = open(path, flags | O_CREAT | O_TRUNC, 0666);
+    if (*fd < 0)
+    {
+        return jarr_file_error_io;
+    }
+    if ((jarr_file_write_all(*fd, &h, sizeof (h)) != jarr_file_ok)
+        || (ftruncate(*fd, (off_t) (jarr_file_header_size
+                                    + (jarr_bltoel(length_bits)
+                                       * sizeof (jarr_element_t)))) != 0))
+    {
+        close(*fd);
+        return jarr_file_error_io;
+    }
+    return jarr_file_ok;
+}
+
+enum jarr_file_status jarr_create_file(char const* const path,
+                                       jarr_length_t const length_bits)
+{
+    int fd;
+    enum jarr_file_status const status = jarr_file_create(path, length_bits,
+                                                          O_WRONLY, &fd);
+    if (status != jarr_file_ok)
+    {
+        return status;
+    }
+    return (close(fd) == 0) ? jarr_file_ok : jarr_file_error_io;
+}
+
+// maps a file, f->j then points into the mapping. Mapping takes the same time
+// however long the jarr is unless verify is set, in which case the checksum
+// is checked, reading the whole file
+
+enum jarr_file_status jarr_map_file(struct jarr_file * const f,
+                                    char const* const path,
+                                    enum jarr_file_mode const mode,
+                                    unsigned char const verify)
+{
+    int const fd = open(path, (mode == jarr_file_read_write) ? O_RDWR
+                        : O_RDONLY);
+    if (fd < 0)
+    {
+        return jarr_file_error_io;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return jarr_file_error_io;
+    }
+    if ((size_t) st.st_size < jarr_file_header_size)
+    {
+        close(fd);
+        return jarr_file_error_format;
+    }
+    void * const map = mmap(NULL, (size_t) st.st_size, (mode
+                            == jarr_file_read_write) ? PROT_READ | PROT_WRITE
+                            : PROT_READ, (mode == jarr_file_read_write)
+                            ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    // the mapping holds its own reference to the file
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return jarr_file_error_io;
+    }
+
+    struct jarr_file_header h;
+    memcpy(&h, map, sizeof (h));
+    enum jarr_file_status status = jarr_file_check_header(&h, (size_t)
+                                                          st.st_size);
+    if (status == jarr_file_ok)
+    {
+        f->j = jarr_init((jarr_element_t*) ((unsigned char*) map
+                         + jarr_file_header_size), (jarr_length_t)
+                         h.length_bits);
+        if ((verify != 0) && (jarr_checksum(&f->j) != h.checksum))
+        {
+            status = jarr_file_error_checksum;
+        }
+    }
+    if (status != jarr_file_ok)
+    {
+        munmap(map, (size_t) st.st_size);
+        return status;
+    }
+    f->map = map;
+    f->map_length = (size_t) st.st_size;
+    f->mode = mode;
+    return jarr_file_ok;
+}
+
+static void jarr_file_update_checksum(struct jarr_file * const f)
+{
+    uint64_t const checksum = jarr_checksum(&f->j);
+    memcpy((unsigned char*) f->map + offsetof(struct jarr_file_header,
+                                              checksum), &checksum,
+           sizeof (checksum));
+}
+
+// brings the checksum of a read/write mapping up to date and writes it back
+// to the file, waiting for the write to finish if wait is set
+
+enum jarr_file_status jarr_file_sync(struct jarr_file * const f,
+                                     unsigned char const wait)
+{
+    if (f->mode != jarr_file_read_write)
+    {
+        return jarr_file_ok;
+    }
+    jarr_file_update_checksum(f);
+    return (msync(f->map, f->map_length, (wait != 0) ? MS_SYNC : MS_ASYNC)
+            == 0) ? jarr_file_ok : jarr_file_error_io;
+}
+
+// unmaps a file, the checksum of a read/write mapping is brought up to date
+// first but the kernel writes it back in its own time
+
+enum jarr_file_status jarr_unmap(struct jarr_file * const f)
+{
+    if (f->mode == jarr_file_read_write)
+    {
+        jarr_file_update_checksum(f);
+    }
+    enum jarr_file_status const status = (munmap(f->map, f->map_length) == 0)
+            ? jarr_file_ok : jarr_file_error_io;
+    f->map = NULL;
+    f->map_length = 0;
+    return status;
+}
+
+// reads all of a buffer from an offset, retrying short reads and reads
+// interrupted by a signal
+
+static enum jarr_file_status jarr_file_read_all(int const fd,
+                                                void * const buffer,
+                                                size_t length, off_t offset)
+{
+    unsigned char* bytes = (unsigned char*) buffer;
+    while (length != (size_t) 0U)
+    {
+        ssize_t const read = pread(fd, bytes, length, offset);
+        if (read <= 0)
+        {
+            if ((read < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            return (read == 0) ? jarr_file_error_format : jarr_file_error_io;
+        }
+        bytes += read;
+        length -= (size_t) read;
+        offset += read;
+    }
+    return jarr_file_ok;
+}
+
+// writes all of a buffer at an offset, retrying short writes and writes
+// interrupted by a signal
+
+static enum jarr_file_status jarr_file_pwrite_all(int const fd,
+                                                  void const* const buffer,
+                                                  size_t length, off_t offset)
+{
+    unsigned char const* bytes = (unsigned char const*) buffer;
+    while (length != (size_t) 0U)
+    {
+        ssize_t const written = pwrite(fd, bytes, length, offset);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return jarr_file_error_io;
+        }
+        bytes += written;
+        length -= (size_t) written;
+        offset += written;
+    }
+    return jarr_file_ok;
+}
+
+// the offset in a file of the element containing bit
+
+static off_t jarr_file_offset(jarr_length_t const bit)
+{
+    return (off_t) (jarr_file_header_size + (jarr_bitoei(bit)
+            * sizeof (jarr_element_t)));
+}
+
+// opens a file to be read a window at a time
+
+enum jarr_file_status jarr_stream_open(struct jarr_stream * const s,
+                                       char const* const path)
+{
+    int const fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return jarr_file_error_io;
+    }
+    struct stat st;
+    struct jarr_file_header h;
+    enum jarr_file_status status = jarr_file_ok;
+    if (fstat(fd, &st) != 0)
+    {
+        status = jarr_file_error_io;
+    }
+    else if ((size_t) st.st_size < jarr_file_header_size)
+    {
+        status = jarr_file_error_format;
+    }
+    else
+    {
+        status = jarr_file_read_all(fd, &h, sizeof (h), 0);
+        if (status == jarr_file_ok)
+        {
+            status = jarr_file_check_header(&h, (size_t) st.st_size);
+        }
+    }
+    if (status != jarr_file_ok)
+    {
+        close(fd);
+        return status;
+    }
+    s->fd = fd;
+    s->length_bits = (jarr_length_t) h.length_bits;
+    s->mode = jarr_file_read;
+    s->sum = 0;
+    return jarr_file_ok;
+}
+
+// creates a cleared file to be written a window at a time, replacing it if it
+// exists
+
+enum jarr_file_status jarr_stream_create(struct jarr_stream * const s,
+                                         char const* const path,
+                                         jarr_length_t const length_bits)
+{
+    int fd;
+    enum jarr_file_status const status = jarr_file_create(path, length_bits,
+                                                          O_RDWR, &fd);
+    if (status != jarr_file_ok)
+    {
+        return status;
+    }
+    s->fd = fd;
+    s->length_bits = length_bits;
+    s->mode = jarr_file_read_write;
+    s->sum = 0;
+    return jarr_file_ok;
+}
+
+// reads window->length_bits bits from startbit into a window, startbit must be
+// a multiple of the element length
+
+enum jarr_file_status jarr_stream_read(struct jarr_stream const* const s,
+                                       struct jarr * const window,
+                                       jarr_length_t const startbit)
+{
+    if ((startbit % jarr_element_length) != 0U)
+    {
+        return jarr_file_error_alignment;
+    }
+    if ((startbit > s->length_bits)
+        || (window->length_bits > s->length_bits - startbit))
+    {
+        return jarr_file_error_length;
+    }
+    return jarr_file_read_all(s->fd, window->arr, window->length_elements
+                              * sizeof (jarr_element_t),
+                              jarr_file_offset(startbit));
+}
+
+// the part of the checksum sum of length bytes of a stream's elements from the
+// word word_index, read back from the file. The bits above length_bits are
+// cleared in the file so the words are summed as they are
+
+static enum jarr_file_status jarr_stream_sum(struct jarr_stream const* const s,
+                                             uint64_t word_index,
+                                             size_t length,
+                                             uint64_t * const sum)
+{
+    uint64_t words[64];
+    off_t offset = (off_t) (jarr_file_header_size + (word_index * 8U));
+    uint64_t part = 0;
+    while (length != (size_t) 0U)
+    {
+        size_t const chunk = (length < sizeof (words)) ? length
+                : sizeof (words);
+        size_t i;
+        // the last word may be short
+        words[(chunk - 1U) / 8U] = 0;
+        enum jarr_file_status const status = jarr_file_read_all(s->fd, words,
+                                                                chunk,
+                                                                offset);
+        if (status != jarr_file_ok)
+        {
+            return status;
+        }
+        for (i = 0; i < (chunk + 7U) / 8U; ++i, ++word_index)
+        {
+            part += jarr_checksum_mix(words[i]) * ((2U * word_index) + 1U);
+        }
+        length -= chunk;
+        offset += (off_t) chunk;
+    }
+    *sum = part;
+    return jarr_file_ok;
+}
+
+// writes a window to the file from startbit. startbit must be a multiple of 64
+// and the window must end at the end of the jarr or be a multiple of 64 bits
+// long. The checksum is kept as the windows are written, the words a window
+// replaces are read back first so that their part can be taken out of it
+
+enum jarr_file_status jarr_stream_write(struct jarr_stream * const s,
+                                        struct jarr const* const window,
+                                        jarr_length_t const startbit)
+{
+    if (s->mode != jarr_file_read_write)
+    {
+        return jarr_file_error_mode;
+    }
+    if ((startbit > s->length_bits)
+        || (window->length_bits > s->length_bits - startbit))
+    {
+        return jarr_file_error_length;
+    }
+    if (((startbit % 64U) != 0U) || (((window->length_bits % 64U) != 0U)
+                                     && (startbit + window->length_bits
+                                         != s->length_bits)))
+    {
+        return jarr_file_error_alignment;
+    }
+    if (window->length_elements == (size_t) 0U)
+    {
+        return jarr_file_ok;
+    }
+    // the bits above length_bits go to the file cleared
+    jarr_element_t const lev = jarr_get_lev(window);
+    size_t const length = (window->length_elements - (size_t) 1U)
+            * sizeof (jarr_element_t);
+    uint64_t old_sum;
+    enum jarr_file_status status = jarr_stream_sum(s, startbit / 64U, length
+                                                   + sizeof (lev), &old_sum);
+    if (status == jarr_file_ok)
+    {
+        status = jarr_file_pwrite_all(s->fd, window->arr, length,
+                                      jarr_file_offset(startbit));
+    }
+    if (status == jarr_file_ok)
+    {
+        status = jarr_file_pwrite_all(s->fd, &lev, sizeof (lev),
+                                      jarr_file_offset(startbit) + (off_t)
+                                      length);
+    }
+    if (status == jarr_file_ok)
+    {
+        s->sum += jarr_checksum_sum(window, startbit / 64U) - old_sum;
+    }
+    return status;
+}
+
+// closes a file, a file being written gets the checksum of everything written
+// to it
+
+enum jarr_file_status jarr_stream_close(struct jarr_stream * const s)
+{
+    enum jarr_file_status status = jarr_file_ok;
+    if (s->mode == jarr_file_read_write)
+    {
+        uint64_t const checksum = jarr_checksum_finish(s->sum, s->length_bits);
+        status = jarr_file_pwrite_all(s->fd, &checksum, sizeof (checksum),
+                                      (off_t) offsetof(struct
+                                                       jarr_file_header,
+                                                       checksum));
+    }
+    if ((close(s->fd) != 0) && (status == jarr_file_ok))
+    {
+        status = jarr_file_error_io;
+    }
+    s->fd = -1;
+    return status;
+}
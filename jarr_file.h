@@ -0,0 +1,119 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_FILE_H
+#define	JARR_FILE_H
+
+#include "jarr.h"
+
+#include <stdint.h>
+
+// jarrs stored in files and memory mapped so that opening one does not read
+// it. A file is a 64 byte header followed by the elements as they are in
+// memory. The header records the length, the element width, the byte order
+// and a checksum of the elements, a file can only be mapped by a build with
+// the same element width and byte order. Needs POSIX mmap
+
+#define jarr_file_header_size 64U
+#define jarr_file_version 1U
+
+enum jarr_file_status
+{
+    jarr_file_ok,
+    // open, stat, mmap, msync or write failed, errno says why
+    jarr_file_error_io,
+    // not a jarr file, an unknown version or shorter than its header says
+    jarr_file_error_format,
+    jarr_file_error_width,
+    jarr_file_error_byte_order,
+    jarr_file_error_checksum,
+    // a window of a stream is not where it must be
+    jarr_file_error_alignment,
+    // a window runs past the end of a stream or the streams an operation works
+    // on differ in length
+    jarr_file_error_length,
+    // the buffer given to a streaming operation cannot hold its windows
+    jarr_file_error_buffer,
+    // a stream opened to be read was written to
+    jarr_file_error_mode
+};
+
+enum jarr_file_mode
+{
+    // the mapping is read only, writing to the jarr faults
+    jarr_file_read,
+    // the mapping is shared, writes to the jarr go to the file
+    jarr_file_read_write
+};
+
+struct jarr_file
+{
+    // points straight into the mapping
+    struct jarr j;
+    void* map;
+    size_t map_length;
+    enum jarr_file_mode mode;
+};
+
+// a file read or written a window at a time without mapping it
+
+struct jarr_stream
+{
+    int fd;
+    jarr_length_t length_bits;
+    enum jarr_file_mode mode;
+    // the checksum of the windows written so far, before it is finished
+    uint64_t sum;
+};
+
+enum jarr_file_status jarr_write_file(char const* const path,
+                                      struct jarr const* const j);
+enum jarr_file_status jarr_create_file(char const* const path,
+                                       jarr_length_t const length_bits);
+enum jarr_file_status jarr_map_file(struct jarr_file * const f,
+                                    char const* const path,
+                                    enum jarr_file_mode const mode,
+                                    unsigned char const verify);
+enum jarr_file_status jarr_file_sync(struct jarr_file * const f,
+                                     unsigned char const wait);
+enum jarr_file_status jarr_unmap(struct jarr_file * const f);
+uint64_t jarr_checksum(struct jarr const* const j);
+uint64_t jarr_checksum_sum(struct jarr const* const j,
+                           uint64_t const word_index);
+uint64_t jarr_checksum_finish(uint64_t const sum,
+                              jarr_length_t const length_bits);
+enum jarr_file_status jarr_stream_open(struct jarr_stream * const s,
+                                       char const* const path);
+enum jarr_file_status jarr_stream_create(struct jarr_stream * const s,
+                                         char const* const path,
+                                         jarr_length_t const length_bits);
+enum jarr_file_status jarr_stream_read(struct jarr_stream const* const s,
+                                       struct jarr * const window,
+                                       jarr_length_t const startbit);
+enum jarr_file_status jarr_stream_write(struct jarr_stream * const s,
+                                        struct jarr const* const window,
+                                        jarr_length_t const startbit);
+enum jarr_file_status jarr_stream_close(struct jarr_stream * const s);
+
+#endif
@@ -0,0 +1,250 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr_hash.h"
+
+#include <string.h>
+
+// the constants of wyhash
+
+#define jarr_hash_p0 0xa0761d6478bd642fU
+#define jarr_hash_p1 0xe7037ed1a0b428dbU
+#define jarr_hash_p2 0x8ebc6af09c88c6e3U
+#define jarr_hash_p3 0x589965cc75374cc3U
+
+// the 128 bit product of a and b folded to 64 bits
+
+static uint64_t jarr_hash_mum(uint64_t const a, uint64_t const b)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 const r = (unsigned __int128) a * b;
+    return (uint64_t) r ^ (uint64_t) (r >> 64U);
+#else
+    uint64_t const a_lo = a & 0xffffffffU;
+    uint64_t const a_hi = a >> 32U;
+    uint64_t const b_lo = b & 0xffffffffU;
+    uint64_t const b_hi = b >> 32U;
+    uint64_t const lo_lo = a_lo * b_lo;
+    uint64_t const hi_lo = a_hi * b_lo;
+    uint64_t const lo_hi = a_lo * b_hi;
+    uint64_t const cross = (lo_lo >> 32U) + (hi_lo & 0xffffffffU) + lo_hi;
+    uint64_t const hi = (a_hi * b_hi) + (hi_lo >> 32U) + (cross >> 32U);
+    uint64_t const lo = (cross << 32U) | (lo_lo & 0xffffffffU);
+    return lo ^ hi;
+#endif
+}
+
+static uint64_t jarr_hash_load(unsigned char const* const bytes)
+{
+    uint64_t word;
+    memcpy(&word, bytes, sizeof (word));
+    return word;
+}
+
+// a hash of the bits of a jarr in the style of wyhash, bits above length_bits
+// are ignored. The elements are read as 64 bit words, 2 lanes each multiplying
+// a pair of words together at a time so that the multiplies overlap. jarrs
+// that differ only in the element width or byte order of the build hash the
+// same on little endian machines
+
+uint64_t jarr_hash(struct jarr const* const j, uint64_t const seed)
+{
+    uint64_t s[2] = {
+        seed ^ jarr_hash_p0,
+        seed ^ jarr_hash_p2
+    };
+    if (j->length_elements != (size_t) 0U)
+    {
+        unsigned char const* const bytes = (unsigned char const*) j->arr;
+        size_t const length = (j->length_elements - (size_t) 1U)
+                * sizeof (jarr_element_t);
+        size_t i;
+        for (i = 0; i + 32U <= length; i += 32U)
+        {
+            s[0] = jarr_hash_mum(jarr_hash_load(bytes + i) ^ jarr_hash_p1,
+                                 jarr_hash_load(bytes + i + 8U) ^ s[0]);
+            s[1] = jarr_hash_mum(jarr_hash_load(bytes + i + 16U)
+                                 ^ jarr_hash_p3, jarr_hash_load(bytes + i
+                                 + 24U) ^ s[1]);
+        }
+        // the rest, then the masked last element, padded with 0s to a whole
+        // number of pairs of words
+        unsigned char tail[48] = {0};
+        jarr_element_t const lev = jarr_get_lev(j);
+        memcpy(tail, bytes + i, length - i);
+        memcpy(tail + (length - i), &lev, sizeof (lev));
+        size_t const tail_length = (length - i) + sizeof (lev);
+        size_t lane = 0;
+        for (i = 0; i < tail_length; i += 16U, lane ^= 1U)
+        {
+            s[lane] = jarr_hash_mum(jarr_hash_load(tail + i) ^ (lane
+                    ? jarr_hash_p3 : jarr_hash_p1), jarr_hash_load(tail + i
+                    + 8U) ^ s[lane]);
+        }
+    }
+    uint64_t const h = jarr_hash_mum(s[0] ^ jarr_hash_p0, s[1]
+            ^ (uint64_t) j->length_bits);
+    return jarr_hash_mum(h ^ jarr_hash_p1, jarr_hash_p2);
+}
+
+// a set of keys of length_bits bits in capacity slots, capacity must be a
+// power of 2 of at least 2. keys must hold
+// jarr_hash_set_length(capacity, length_bits) elements and hashes capacity
+// hashes. The hashes are cleared, the keys are only written as they are added
+
+struct jarr_hash_set jarr_hash_set_init(jarr_element_t * const _keys,
+                                        uint64_t * const _hashes,
+                                        size_t const _capacity,
+                                        jarr_length_t const _length_bits,
+                                        uint64_t const _seed)
+{
+    struct jarr_hash_set s;
+    s.keys = _keys;
+    s.hashes = _hashes;
+    s.capacity = _capacity;
+    s.count = 0;
+    s.length_bits = _length_bits;
+    s.stride = jarr_bltoel(_length_bits);
+    s.seed = _seed;
+    memset(_hashes, 0, _capacity * sizeof (uint64_t));
+    return s;
+}
+
+// the hash of a key as stored, never 0
+
+static uint64_t jarr_hash_set_hash(struct jarr_hash_set const* const s,
+                                   struct jarr const* const key)
+{
+    uint64_t const h = jarr_hash(key, s->seed);
+    return (h != 0U) ? h : (uint64_t) 1U;
+}
+
+// the slot holding key, or the empty slot where probing for it stopped. The
+// full hashes are compared before the keys, so keys are only read when they
+// almost certainly match
+
+static size_t jarr_hash_set_probe(struct jarr_hash_set const* const s,
+                                  struct jarr const* const key,
+                                  uint64_t const h)
+{
+    size_t const mask = s->capacity - (size_t) 1U;
+    size_t slot = (size_t) h & mask;
+    while (s->hashes[slot] != 0U)
+    {
+        if (s->hashes[slot] == h)
+        {
+            struct jarr const stored = jarr_hash_set_key(s, slot);
+            if (jarr_equal(&stored, key))
+            {
+                break;
+            }
+        }
+        slot = (slot + (size_t) 1U) & mask;
+    }
+    return slot;
+}
+
+// whether another key can be added, one slot is always left empty so that
+// probing stops
+
+static unsigned char jarr_hash_set_room(struct jarr_hash_set const* const s)
+{
+    return s->count < s->capacity - (s->capacity / jarr_hash_set_free_divisor)
+            - (size_t) 1U;
+}
+
+static void jarr_hash_set_store(struct jarr_hash_set * const s,
+                                size_t const slot, uint64_t const h,
+                                struct jarr const* const key)
+{
+    jarr_element_t * const stored = s->keys + (slot * s->stride);
+    if (s->stride != (size_t) 0U)
+    {
+        // keys are stored with the bits above length_bits clear
+        memcpy(stored, key->arr, (s->stride - (size_t) 1U)
+               * sizeof (jarr_element_t));
+        stored[s->stride - (size_t) 1U] = jarr_get_lev(key);
+    }
+    s->hashes[slot] = h;
+    ++s->count;
+}
+
+// adds a key, which must be length_bits long, if it is not already in the set
+
+enum jarr_hash_set_status jarr_hash_set_insert(struct jarr_hash_set * const s,
+                                               struct jarr const* const key)
+{
+    uint64_t const h = jarr_hash_set_hash(s, key);
+    size_t const slot = jarr_hash_set_probe(s, key, h);
+    if (s->hashes[slot] != 0U)
+    {
+        return jarr_hash_set_present;
+    }
+    if (!jarr_hash_set_room(s))
+    {
+        return jarr_hash_set_full;
+    }
+    jarr_hash_set_store(s, slot, h, key);
+    return jarr_hash_set_added;
+}
+
+unsigned char jarr_hash_set_contains(struct jarr_hash_set const* const s,
+                                     struct jarr const* const key)
+{
+    uint64_t const h = jarr_hash_set_hash(s, key);
+    return s->hashes[jarr_hash_set_probe(s, key, h)] != 0U;
+}
+
+// adds every key of in to out, which would normally be empty and larger, the
+// stored hashes are reused if both have the same seed. Returns 1 if out
+// becomes full, or holds keys of a different length
+
+unsigned char jarr_hash_set_rehash(struct jarr_hash_set * const out,
+                                   struct jarr_hash_set const* const in)
+{
+    if (out->length_bits != in->length_bits)
+    {
+        return 1;
+    }
+    size_t slot;
+    for (slot = 0; slot < in->capacity; ++slot)
+    {
+        if (in->hashes[slot] != 0U)
+        {
+            struct jarr const key = jarr_hash_set_key(in, slot);
+            uint64_t const h = (out->seed == in->seed) ? in->hashes[slot]
+                    : jarr_hash_set_hash(out, &key);
+            size_t const to = jarr_hash_set_probe(out, &key, h);
+            if (out->hashes[to] == 0U)
+            {
+                if (!jarr_hash_set_room(out))
+                {
+                    return 1;
+                }
+                jarr_hash_set_store(out, to, h, &key);
+            }
+        }
+    }
+    return 0;
+}
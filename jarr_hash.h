@@ -0,0 +1,93 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_HASH_H
+#define	JARR_HASH_H
+
+#include "jarr.h"
+
+#include <stdint.h>
+
+// hashing jarrs by their contents, and a set of jarrs of one length for
+// removing duplicates. The set is open addressed with linear probing, its keys
+// are stored one after another in one caller provided buffer of elements and
+// the hash of each key in a parallel buffer, a hash of 0 marking an empty slot
+
+// the set is full past capacity - capacity / jarr_hash_set_free_divisor keys,
+// so that probe sequences stay short
+#ifndef jarr_hash_set_free_divisor
+#define jarr_hash_set_free_divisor 8U
+#endif
+
+enum jarr_hash_set_status
+{
+    jarr_hash_set_added,
+    jarr_hash_set_present,
+    // the key is not in the set and there is no room for it
+    jarr_hash_set_full
+};
+
+struct jarr_hash_set
+{
+    jarr_element_t* keys;
+    uint64_t* hashes;
+    // slots, a power of 2
+    size_t capacity;
+    size_t count;
+    jarr_length_t length_bits;
+    // elements per key
+    size_t stride;
+    uint64_t seed;
+};
+
+uint64_t jarr_hash(struct jarr const* const j, uint64_t const seed);
+struct jarr_hash_set jarr_hash_set_init(jarr_element_t * const _keys,
+                                        uint64_t * const _hashes,
+                                        size_t const _capacity,
+                                        jarr_length_t const _length_bits,
+                                        uint64_t const _seed);
+enum jarr_hash_set_status jarr_hash_set_insert(struct jarr_hash_set * const s,
+                                               struct jarr const* const key);
+unsigned char jarr_hash_set_contains(struct jarr_hash_set const* const s,
+                                     struct jarr const* const key);
+unsigned char jarr_hash_set_rehash(struct jarr_hash_set * const out,
+                                   struct jarr_hash_set const* const in);
+
+// elements needed for the keys of a set
+
+inline static size_t jarr_hash_set_length(size_t const capacity,
+                                          jarr_length_t const length_bits)
+{
+    return capacity * jarr_bltoel(length_bits);
+}
+
+// the key in a slot as a jarr, only meaningful if the slot's hash is not 0
+
+inline static struct jarr jarr_hash_set_key(struct jarr_hash_set const* const
+                                            s, size_t const slot)
+{
+    return jarr_init(s->keys + (slot * s->stride), s->length_bits);
+}
+
+#endif
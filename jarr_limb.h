@@ -0,0 +1,114 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+// internal helpers for arithmetic on 64 bit limbs, not part of the public api
+
+#ifndef JARR_LIMB_H
+#define	JARR_LIMB_H
+
+#include "jarr.h"
+
+#include <stdint.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// whether elements can be read from memory as 64 bit limbs, when the elements
+// are narrower than a limb this relies on a little endian byte order so that
+// a limb holds its elements in order of significance
+
+#if (jarr_element_bits == 64) || (defined(__BYTE_ORDER__) \
+    && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+#define jarr_limbs 1
+#else
+#define jarr_limbs 0
+#endif
+
+#define jarr_limb_bits 64U
+
+// adds 2 limbs and a carry, returning the carry out
+
+inline static unsigned char jarr_addcarry_u64(unsigned char const carry,
+                                              uint64_t const a,
+                                              uint64_t const b,
+                                              uint64_t * const sum)
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+    unsigned long long s;
+    unsigned char const c = _addcarry_u64(carry, a, b, &s);
+    *sum = s;
+    return c;
+#else
+    uint64_t const s = a + b;
+    *sum = s + carry;
+    return (unsigned char) ((s < a) | (*sum < s));
+#endif
+}
+
+// subtracts a limb and a borrow from another, returning the borrow out
+
+inline static unsigned char jarr_subborrow_u64(unsigned char const borrow,
+                                               uint64_t const a,
+                                               uint64_t const b,
+                                               uint64_t * const difference)
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+    unsigned long long d;
+    unsigned char const c = _subborrow_u64(borrow, a, b, &d);
+    *difference = d;
+    return c;
+#else
+    uint64_t const d = a - b;
+    *difference = d - borrow;
+    return (unsigned char) ((a < b) | (d < borrow));
+#endif
+}
+
+// multiplies 2 limbs, returning the low limb of the product and putting the
+// high limb in hi
+
+inline static uint64_t jarr_mul_u64(uint64_t const a, uint64_t const b,
+                                    uint64_t * const hi)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 const p = (unsigned __int128) a * b;
+    *hi = (uint64_t) (p >> 64);
+    return (uint64_t) p;
+#else
+    uint64_t const a_lo = a & 0xffffffffU;
+    uint64_t const a_hi = a >> 32;
+    uint64_t const b_lo = b & 0xffffffffU;
+    uint64_t const b_hi = b >> 32;
+    uint64_t const ll = a_lo * b_lo;
+    uint64_t const lh = a_lo * b_hi;
+    uint64_t const hl = a_hi * b_lo;
+    uint64_t const middle = (ll >> 32) + (lh & 0xffffffffU)
+            + (hl & 0xffffffffU);
+    *hi = (a_hi * b_hi) + (lh >> 32) + (hl >> 32) + (middle >> 32);
+    return (middle << 32) | (ll & 0xffffffffU);
+#endif
+}
+
+#endif
@@ -0,0 +1,274 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr_matrix.h"
+#include "jarr_simd.h"
+
+#include <string.h>
+
+// elements per 64 bit word
+
+#define jarr_matrix_word_elements (64U / jarr_element_length)
+
+// the rows are padded to whole cache lines, so every row holds whole words
+
+static uint64_t jarr_matrix_load(jarr_element_t const* const row,
+                                 size_t const word)
+{
+    uint64_t w = 0;
+    size_t e;
+    for (e = 0; e < jarr_matrix_word_elements; ++e)
+    {
+        w |= (uint64_t) row[(word * jarr_matrix_word_elements) + e] << (e
+                * jarr_element_length);
+    }
+    return w;
+}
+
+static void jarr_matrix_store(jarr_element_t * const row, size_t const word,
+                              uint64_t const w)
+{
+    size_t e;
+    for (e = 0; e < jarr_matrix_word_elements; ++e)
+    {
+        row[(word * jarr_matrix_word_elements) + e] = (jarr_element_t) (w
+                >> (e * jarr_element_length));
+    }
+}
+
+static jarr_element_t* jarr_matrix_row_arr(struct jarr_matrix const* const m,
+                                           size_t const row)
+{
+    return m->arr + (row * m->stride);
+}
+
+static unsigned char jarr_matrix_read(jarr_element_t const* const row,
+                                      jarr_length_t const col)
+{
+    return (unsigned char) ((row[col / jarr_element_length] >> (col
+            % jarr_element_length)) & 1U);
+}
+
+struct jarr_matrix jarr_matrix_init(jarr_element_t * const _arr,
+                                    size_t const _rows,
+                                    jarr_length_t const _cols)
+{
+    struct jarr_matrix m;
+    m.arr = _arr;
+    m.rows = _rows;
+    m.cols = _cols;
+    m.stride = jarr_matrix_stride(_cols);
+    return m;
+}
+
+// clears the matrix, padding included
+
+void jarr_matrix_clear(struct jarr_matrix * const m)
+{
+    memset(m->arr, 0, m->rows * m->stride * sizeof (jarr_element_t));
+}
+
+// transposes 64 rows of 64 bits in place, row k bit c swapping with row c bit
+// k. Each step swaps the off diagonal blocks of every block of twice the size
+
+static void jarr_matrix_transpose64(uint64_t * const x)
+{
+    unsigned int j = 32U;
+    uint64_t m = 0x00000000ffffffffU;
+    for (; j != 0U; j >>= 1U, m ^= m << j)
+    {
+        unsigned int k;
+        for (k = 0; k < 64U; k = ((k | j) + 1U) & ~j)
+        {
+            uint64_t const t = ((x[k] >> j) ^ x[k | j]) & m;
+            x[k] ^= t << j;
+            x[k | j] ^= t;
+        }
+    }
+}
+
+// out = the transpose of in, a 64 by 64 block at a time. out must have as many
+// rows as in has columns and as many columns as in has rows, it must not be in
+
+void jarr_matrix_transpose(struct jarr_matrix * const out,
+                           struct jarr_matrix const* const in)
+{
+    uint64_t block[64];
+    size_t r;
+    for (r = 0; r < in->rows; r += 64U)
+    {
+        size_t const rows = (in->rows - r < 64U) ? in->rows - r : 64U;
+        jarr_length_t c;
+        for (c = 0; c < in->cols; c += 64U)
+        {
+            size_t const cols = (in->cols - c < 64U) ? (size_t) (in->cols - c)
+                    : 64U;
+            size_t k;
+            for (k = 0; k < rows; ++k)
+            {
+                block[k] = jarr_matrix_load(jarr_matrix_row_arr(in, r + k),
+                                            (size_t) (c / 64U));
+            }
+            for (; k < 64U; ++k)
+            {
+                block[k] = 0;
+            }
+            jarr_matrix_transpose64(block);
+            // the bits of out past its columns come from padding rows of in,
+            // which are 0
+            for (k = 0; k < cols; ++k)
+            {
+                jarr_matrix_store(jarr_matrix_row_arr(out, (size_t) c + k),
+                                  r / 64U, block[k]);
+            }
+        }
+    }
+    // the words of padding past the last block
+    size_t const used = ((in->rows + 63U) / 64U) * jarr_matrix_word_elements;
+    for (r = 0; r < out->rows; ++r)
+    {
+        memset(jarr_matrix_row_arr(out, r) + used, 0, (out->stride - used)
+               * sizeof (jarr_element_t));
+    }
+}
+
+// the elements of scratch jarr_matrix_mul needs for b
+
+size_t jarr_matrix_mul_scratch_length(struct jarr_matrix const* const b)
+{
+    return ((size_t) 1U << jarr_matrix_m4rm_bits) * b->stride;
+}
+
+// out = a * b by the method of four russians. For every jarr_matrix_m4rm_bits
+// rows of b a table of all their sums is built, one xor per entry, then each
+// row of out is xored with the entry picked by those bits of its row of a. out
+// must have the rows of a and the columns of b and must not be either of them
+
+void jarr_matrix_mul(struct jarr_matrix * const out,
+                     struct jarr_matrix const* const a,
+                     struct jarr_matrix const* const b,
+                     jarr_element_t * const scratch)
+{
+    struct jarr_simd_kernels const* const kernels = jarr_simd_get_kernels();
+    size_t const stride = b->stride;
+    jarr_matrix_clear(out);
+    memset(scratch, 0, stride * sizeof (jarr_element_t));
+
+    size_t g;
+    for (g = 0; g < b->rows; g += jarr_matrix_m4rm_bits)
+    {
+        size_t const bits = (b->rows - g < jarr_matrix_m4rm_bits) ? b->rows - g
+                : jarr_matrix_m4rm_bits;
+        // entry e is entry e without its lowest set bit plus the row of b
+        // for that bit
+        size_t const used = (size_t) 1U << bits;
+        size_t e;
+        for (e = 1; e < used; ++e)
+        {
+            size_t low = 0;
+            while (((e >> low) & 1U) == 0U)
+            {
+                ++low;
+            }
+            kernels->bw_xor(scratch + (e * stride),
+                            scratch + ((e & (e - 1U)) * stride),
+                            jarr_matrix_row_arr(b, g + low), stride);
+        }
+
+        size_t r;
+        for (r = 0; r < a->rows; ++r)
+        {
+            size_t index = 0;
+            size_t k;
+            for (k = 0; k < bits; ++k)
+            {
+                index |= (size_t) jarr_matrix_read(jarr_matrix_row_arr(a, r),
+                                                   g + k) << k;
+            }
+            if (index != (size_t) 0U)
+            {
+                jarr_element_t * const row = jarr_matrix_row_arr(out, r);
+                kernels->bw_xor(row, row, scratch + (index * stride), stride);
+            }
+        }
+    }
+}
+
+// gaussian elimination, brings m to row echelon form, or to reduced row
+// echelon form if reduced, and returns its rank. Each pivot row is xored into
+// the others from the element holding the pivot on, the bits before it being
+// 0
+
+size_t jarr_matrix_echelon(struct jarr_matrix * const m,
+                           unsigned char const reduced)
+{
+    struct jarr_simd_kernels const* const kernels = jarr_simd_get_kernels();
+    size_t rank = 0;
+    jarr_length_t c;
+    for (c = 0; (c < m->cols) && (rank < m->rows); ++c)
+    {
+        size_t pivot = rank;
+        while ((pivot < m->rows) && !jarr_matrix_read(jarr_matrix_row_arr(m,
+                pivot), c))
+        {
+            ++pivot;
+        }
+        if (pivot == m->rows)
+        {
+            continue;
+        }
+        size_t const first = (size_t) (c / jarr_element_length);
+        size_t const n = m->stride - first;
+        jarr_element_t * const p = jarr_matrix_row_arr(m, rank) + first;
+        if (pivot != rank)
+        {
+            jarr_element_t * const q = jarr_matrix_row_arr(m, pivot) + first;
+            size_t e;
+            for (e = 0; e < n; ++e)
+            {
+                jarr_element_t const t = p[e];
+                p[e] = q[e];
+                q[e] = t;
+            }
+        }
+        size_t r;
+        for (r = reduced ? 0 : rank + 1U; r < m->rows; ++r)
+        {
+            jarr_element_t * const row = jarr_matrix_row_arr(m, r) + first;
+            if ((r != rank) && jarr_matrix_read(row - first, c))
+            {
+                kernels->bw_xor(row, row, p, n);
+            }
+        }
+        ++rank;
+    }
+    return rank;
+}
+
+// the rank of m, which is left in row echelon form
+
+size_t jarr_matrix_rank(struct jarr_matrix * const m)
+{
+    return jarr_matrix_echelon(m, 0);
+}
@@ -0,0 +1,92 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_MATRIX_H
+#define	JARR_MATRIX_H
+
+#include "jarr.h"
+
+// a dense matrix over GF(2), each row stored like a jarr of length cols. The
+// rows start stride elements apart, a whole number of cache lines, so a row
+// starts on a cache line if the array does and the padding past cols lets rows
+// be worked on a 64 bit word at a time. The array is caller provided and must
+// hold jarr_matrix_length(rows, cols) elements. As with a jarr the bits past
+// cols must be kept 0, the operations here all do
+
+// the bytes each row stride is a multiple of
+#define jarr_matrix_align 64U
+// the rows of b combined into each table by jarr_matrix_mul
+#ifndef jarr_matrix_m4rm_bits
+#define jarr_matrix_m4rm_bits 8U
+#endif
+
+struct jarr_matrix
+{
+    jarr_element_t* arr;
+    size_t rows;
+    jarr_length_t cols;
+    // elements from the start of one row to the start of the next
+    size_t stride;
+};
+
+struct jarr_matrix jarr_matrix_init(jarr_element_t * const _arr,
+                                    size_t const _rows,
+                                    jarr_length_t const _cols);
+void jarr_matrix_clear(struct jarr_matrix * const m);
+void jarr_matrix_transpose(struct jarr_matrix * const out,
+                           struct jarr_matrix const* const in);
+size_t jarr_matrix_mul_scratch_length(struct jarr_matrix const* const b);
+void jarr_matrix_mul(struct jarr_matrix * const out,
+                     struct jarr_matrix const* const a,
+                     struct jarr_matrix const* const b,
+                     jarr_element_t * const scratch);
+size_t jarr_matrix_echelon(struct jarr_matrix * const m,
+                           unsigned char const reduced);
+size_t jarr_matrix_rank(struct jarr_matrix * const m);
+
+// elements per row of a matrix with cols columns
+
+inline static size_t jarr_matrix_stride(jarr_length_t const cols)
+{
+    size_t const line = jarr_matrix_align / sizeof (jarr_element_t);
+    return ((jarr_bltoel(cols) + line - 1U) / line) * line;
+}
+
+// elements needed for a matrix
+
+inline static size_t jarr_matrix_length(size_t const rows,
+                                        jarr_length_t const cols)
+{
+    return rows * jarr_matrix_stride(cols);
+}
+
+// a row as a jarr, changes to it change the matrix
+
+inline static struct jarr jarr_matrix_row(struct jarr_matrix const* const m,
+                                          size_t const row)
+{
+    return jarr_init(m->arr + (row * m->stride), m->cols);
+}
+
+#endif
@@ -0,0 +1,314 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr.h"
+#include "jarr_limb.h"
+
+#include <string.h>
+
+// the number of limbs below which jarr_mul multiplies with the schoolbook
+// method rather than Karatsuba's, must be at least 4
+
+#ifndef jarr_karatsuba_threshold
+#define jarr_karatsuba_threshold 32
+#endif
+
+#if jarr_karatsuba_threshold < 4
+#error "jarr_karatsuba_threshold must be at least 4"
+#endif
+
+// the number of limbs needed to hold bit_length bits
+
+static size_t jarr_bltoll(jarr_length_t const bit_length)
+{
+    return (size_t) ((bit_length + jarr_limb_bits - 1U) / jarr_limb_bits);
+}
+
+// r = a + b over n limbs, returns the carry out, r may be a or b
+
+static unsigned char jarr_mul_add_n(uint64_t * const r, uint64_t const* const a,
+                                    uint64_t const* const b, size_t const n)
+{
+    unsigned char carry = 0;
+    size_t i;
+    for (i = 0; i < n; ++i)
+    {
+        carry = jarr_addcarry_u64(carry, a[i], b[i], &r[i]);
+    }
+    return carry;
+}
+
+// r = a - b over n limbs, returns the borrow out, r may be a or b
+
+static unsigned char jarr_mul_sub_n(uint64_t * const r, uint64_t const* const a,
+                                    uint64_t const* const b, size_t const n)
+{
+    unsigned char borrow = 0;
+    size_t i;
+    for (i = 0; i < n; ++i)
+    {
+        borrow = jarr_subborrow_u64(borrow, a[i], b[i], &r[i]);
+    }
+    return borrow;
+}
+
+// propagates a carry into the n limbs of r, returns the carry out
+
+static unsigned char jarr_mul_add_1(uint64_t * const r, size_t const n,
+                                    unsigned char carry)
+{
+    size_t i;
+    for (i = 0; (i < n) && (carry != 0); ++i)
+    {
+        carry = jarr_addcarry_u64(carry, r[i], 0, &r[i]);
+    }
+    return carry;
+}
+
+// propagates a borrow into the n limbs of r, returns the borrow out
+
+static unsigned char jarr_mul_sub_1(uint64_t * const r, size_t const n,
+                                    unsigned char borrow)
+{
+    size_t i;
+    for (i = 0; (i < n) && (borrow != 0); ++i)
+    {
+        borrow = jarr_subborrow_u64(borrow, r[i], 0, &r[i]);
+    }
+    return borrow;
+}
+
+// r += a * b over n limbs, returns the limb carried out
+
+static uint64_t jarr_mul_addmul_1(uint64_t * const r, uint64_t const* const a,
+                                  size_t const n, uint64_t const b)
+{
+    uint64_t carry = 0;
+    size_t i;
+    for (i = 0; i < n; ++i)
+    {
+        uint64_t hi;
+        uint64_t lo = jarr_mul_u64(a[i], b, &hi);
+        hi += jarr_addcarry_u64(0, lo, carry, &lo);
+        hi += jarr_addcarry_u64(0, lo, r[i], &lo);
+        r[i] = lo;
+        carry = hi;
+    }
+    return carry;
+}
+
+// r = a * b, r must hold na + nb limbs and not overlap a or b
+
+static void jarr_mul_schoolbook(uint64_t * const r, uint64_t const* const a,
+                                size_t const na, uint64_t const* const b,
+                                size_t const nb)
+{
+    memset(r, 0, na * sizeof (*r));
+    size_t j;
+    for (j = 0; j < nb; ++j)
+    {
+        r[j + na] = jarr_mul_addmul_1(r + j, a, na, b[j]);
+    }
+}
+
+// the scratch space jarr_mul_karatsuba needs for n limb operands
+
+static size_t jarr_mul_karatsuba_scratch(size_t n)
+{
+    size_t scratch = 0;
+    while (n >= jarr_karatsuba_threshold)
+    {
+        size_t const l = n - (n / 2U);
+        scratch += 4U * (l + 1U);
+        n = l + 1U;
+    }
+    return scratch;
+}
+
+// r = a * b for n limb operands, r must hold 2n limbs and not overlap a, b or
+// tmp. Each operand is split into a low half of l limbs and a high half of h
+// limbs, the middle product comes from (a0 + a1)(b0 + b1) - a0b0 - a1b1
+
+static void jarr_mul_karatsuba(uint64_t * const r, uint64_t const* const a,
+                               uint64_t const* const b, size_t const n,
+                               uint64_t * const tmp)
+{
+    if (n < jarr_karatsuba_threshold)
+    {
+        jarr_mul_schoolbook(r, a, n, b, n);
+        return;
+    }
+
+    size_t const h = n / 2U;
+    size_t const l = n - h;
+    uint64_t * const sa = tmp;
+    uint64_t * const sb = sa + l + 1U;
+    uint64_t * const z1 = sb + l + 1U;
+    uint64_t * const next_tmp = z1 + (2U * (l + 1U));
+
+    // a0b0 and a1b1 go straight into the low and high halves of r
+    jarr_mul_karatsuba(r, a, b, l, next_tmp);
+    jarr_mul_karatsuba(r + (2U * l), a + l, b + l, h, next_tmp);
+
+    memcpy(sa, a, l * sizeof (*sa));
+    sa[l] = jarr_mul_add_1(sa + h, l - h, jarr_mul_add_n(sa, sa, a + l, h));
+    memcpy(sb, b, l * sizeof (*sb));
+    sb[l] = jarr_mul_add_1(sb + h, l - h, jarr_mul_add_n(sb, sb, b + l, h));
+
+    jarr_mul_karatsuba(z1, sa, sb, l + 1U, next_tmp);
+    jarr_mul_sub_1(z1 + (2U * l), 2U, jarr_mul_sub_n(z1, z1, r, 2U * l));
+    jarr_mul_sub_1(z1 + (2U * h), (2U * (l + 1U)) - (2U * h),
+                   jarr_mul_sub_n(z1, z1, r + (2U * l), 2U * h));
+
+    // the middle product is at most l + h + 1 limbs, anything above the end
+    // of r is 0
+    size_t const z1_length = ((2U * (l + 1U)) < (2U * n) - l)
+            ? 2U * (l + 1U) : (2U * n) - l;
+    jarr_mul_add_1(r + l + z1_length, (2U * n) - l - z1_length,
+                   jarr_mul_add_n(r + l, r + l, z1, z1_length));
+}
+
+// loads a jarr into limbs, the bits above length_bits are cleared
+
+static void jarr_mul_to_limbs(uint64_t * const limbs, struct jarr const* const j)
+{
+    size_t const length_limbs = jarr_bltoll(j->length_bits);
+#if jarr_limbs != 0
+    memset(limbs, 0, length_limbs * sizeof (*limbs));
+    memcpy(limbs, j->arr, (j->length_elements - (size_t) 1U)
+           * sizeof (jarr_element_t));
+#else
+    memset(limbs, 0, length_limbs * sizeof (*limbs));
+    size_t e;
+    for (e = 0; e < j->length_elements - (size_t) 1U; ++e)
+    {
+        jarr_length_t const bit = (jarr_length_t) e * jarr_element_length;
+        limbs[bit / jarr_limb_bits] |= (uint64_t) j->arr[e] << (bit
+                % jarr_limb_bits);
+    }
+#endif
+    jarr_length_t const bit = (jarr_length_t) (j->length_elements - (size_t) 1U)
+            * jarr_element_length;
+    limbs[bit / jarr_limb_bits] |= (uint64_t) jarr_get_lev(j) << (bit
+            % jarr_limb_bits);
+}
+
+// stores the low length_bits bits of a number of length_limbs limbs
+
+static void jarr_mul_from_limbs(struct jarr * const j,
+                                uint64_t const* const limbs,
+                                size_t const length_limbs)
+{
+    size_t e;
+    for (e = 0; e < j->length_elements; ++e)
+    {
+        jarr_length_t const bit = (jarr_length_t) e * jarr_element_length;
+        size_t const limb = (size_t) (bit / jarr_limb_bits);
+        j->arr[e] = (limb < length_limbs) ? (jarr_element_t) (limbs[limb]
+                >> (bit % jarr_limb_bits)) : (jarr_element_t) 0;
+    }
+}
+
+// the number of limbs of scratch space jarr_mul needs for operands of these
+// lengths
+
+size_t jarr_mul_scratch_length(jarr_length_t const a_bits,
+                               jarr_length_t const b_bits)
+{
+    size_t const na = jarr_bltoll(a_bits);
+    size_t const nb = jarr_bltoll(b_bits);
+    size_t const n_short = (na < nb) ? na : nb;
+    // the operands, the product, then for a chunked product a chunk of the
+    // longer operand, its product and the Karatsuba temporaries
+    return (2U * (na + nb)) + (3U * n_short)
+            + jarr_mul_karatsuba_scratch(n_short);
+}
+
+// out = a * b truncated to the length of out, scratch must hold
+// jarr_mul_scratch_length(a->length_bits, b->length_bits) limbs. out may be a
+// or b
+
+void jarr_mul(struct jarr * const out, struct jarr const* const a,
+              struct jarr const* const b, uint64_t * const scratch)
+{
+    size_t na = jarr_bltoll(a->length_bits);
+    size_t nb = jarr_bltoll(b->length_bits);
+    uint64_t * la = scratch;
+    uint64_t * lb = la + na;
+    uint64_t * const product = lb + nb;
+    jarr_mul_to_limbs(la, a);
+    jarr_mul_to_limbs(lb, b);
+
+    // leading zero limbs contribute nothing
+    while ((na != (size_t) 0U) && (la[na - (size_t) 1U] == 0U))
+    {
+        --na;
+    }
+    while ((nb != (size_t) 0U) && (lb[nb - (size_t) 1U] == 0U))
+    {
+        --nb;
+    }
+    if ((na == (size_t) 0U) || (nb == (size_t) 0U))
+    {
+        jarr_mul_from_limbs(out, product, 0);
+        return;
+    }
+    if (na < nb)
+    {
+        uint64_t * const swap = la;
+        size_t const swap_n = na;
+        la = lb;
+        na = nb;
+        lb = swap;
+        nb = swap_n;
+    }
+
+    if (nb < jarr_karatsuba_threshold)
+    {
+        jarr_mul_schoolbook(product, la, na, lb, nb);
+    }
+    else
+    {
+        // multiply the longer operand a chunk the length of the shorter one at
+        // a time, the last chunk is zero padded
+        uint64_t * const chunk = product + na + nb;
+        uint64_t * const chunk_product = chunk + nb;
+        uint64_t * const tmp = chunk_product + (2U * nb);
+        memset(product, 0, (na + nb) * sizeof (*product));
+        size_t offset;
+        for (offset = 0; offset < na; offset += nb)
+        {
+            size_t const n = (na - offset < nb) ? na - offset : nb;
+            memcpy(chunk, la + offset, n * sizeof (*chunk));
+            memset(chunk + n, 0, (nb - n) * sizeof (*chunk));
+            jarr_mul_karatsuba(chunk_product, chunk, lb, nb, tmp);
+            size_t const add = (na + nb) - offset < 2U * nb
+                    ? (na + nb) - offset : 2U * nb;
+            jarr_mul_add_1(product + offset + add, na + nb - offset - add,
+                           jarr_mul_add_n(product + offset, product + offset,
+                                          chunk_product, add));
+        }
+    }
+    jarr_mul_from_limbs(out, product, na + nb);
+}
@@ -0,0 +1,534 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr_parallel.h"
+
+enum jarr_par_op
+{
+    jarr_par_op_and,
+    jarr_par_op_or,
+    jarr_par_op_xor,
+    jarr_par_op_andnot,
+    jarr_par_op_not,
+    jarr_par_op_clear,
+    jarr_par_op_set,
+    jarr_par_op_clear_section,
+    jarr_par_op_set_section,
+    jarr_par_op_popcount,
+    jarr_par_op_popcount_section,
+    jarr_par_op_add,
+    jarr_par_op_increment
+};
+
+// an operation split into chunks of the elements first to first + length of
+// the output. Chunk 0 runs to the first cache line boundary then on for
+// chunk_length elements, every other chunk is chunk_length elements from a
+// boundary
+
+struct jarr_par_job
+{
+    enum jarr_par_op op;
+    struct jarr* out;
+    struct jarr const* in1;
+    struct jarr const* in2;
+    jarr_length_t length;
+    jarr_length_t startbit;
+    // the result of a popcount, summed over the chunks
+    jarr_length_t count;
+    size_t first;
+    size_t length_elements;
+    size_t head;
+    size_t chunk_length;
+    size_t length_chunks;
+    // for an add, whether each chunk generates a carry with no carry in, if
+    // it would propagate one, and its carry in
+    unsigned char generate[jarr_pool_max_chunks];
+    unsigned char propagate[jarr_pool_max_chunks];
+    unsigned char carry[jarr_pool_max_chunks];
+};
+
+// the elements of a chunk, relative to the start of the job
+
+static void jarr_par_chunk(struct jarr_par_job const* const job,
+                           size_t const chunk, size_t * const first,
+                           size_t * const end)
+{
+    *first = (chunk == (size_t) 0U) ? 0 : job->head + (chunk
+            * job->chunk_length);
+    *end = job->head + ((chunk + 1U) * job->chunk_length);
+    if (*end > job->length_elements)
+    {
+        *end = job->length_elements;
+    }
+}
+
+// a jarr over the elements first to end of j, ending where j does if end is
+// its last element
+
+static struct jarr jarr_par_window(struct jarr const* const j,
+                                   size_t const first, size_t const end)
+{
+    return jarr_init(j->arr + first, (end == j->length_elements)
+                     ? j->length_bits - ((jarr_length_t) first
+                                         * jarr_element_length)
+                     : (jarr_length_t) (end - first) * jarr_element_length);
+}
+
+// runs one chunk of a job
+
+static void jarr_par_run_chunk(struct jarr_par_job * const job,
+                               size_t const chunk)
+{
+    size_t first;
+    size_t end;
+    jarr_par_chunk(job, chunk, &first, &end);
+    first += job->first;
+    end += job->first;
+    struct jarr const j = (job->out != NULL) ? *job->out : *job->in1;
+    struct jarr out = jarr_par_window(&j, first, end);
+    struct jarr in1;
+    struct jarr in2;
+    if (job->in1 != NULL)
+    {
+        in1 = jarr_par_window(job->in1, first, end);
+    }
+    if (job->in2 != NULL)
+    {
+        in2 = jarr_par_window(job->in2, first, end);
+    }
+
+    // the part of a section within the chunk
+    jarr_length_t const chunk_start = (jarr_length_t) first
+            * jarr_element_length;
+    jarr_length_t const chunk_end = (jarr_length_t) end * jarr_element_length;
+    jarr_length_t const section_start = (job->startbit > chunk_start)
+            ? job->startbit : chunk_start;
+    jarr_length_t const section_end = (job->startbit + job->length < chunk_end)
+            ? job->startbit + job->length : chunk_end;
+
+    switch (job->op)
+    {
+    case jarr_par_op_and:
+        jarr_bw_and(&out, &in1, &in2);
+        break;
+    case jarr_par_op_or:
+        jarr_bw_or(&out, &in1, &in2);
+        break;
+    case jarr_par_op_xor:
+        jarr_bw_xor(&out, &in1, &in2);
+        break;
+    case jarr_par_op_andnot:
+        jarr_bw_andnot(&out, &in1, &in2);
+        break;
+    case jarr_par_op_not:
+        jarr_bw_not(&out, &in1);
+        break;
+    case jarr_par_op_clear:
+        jarr_clear_all(&out);
+        break;
+    case jarr_par_op_set:
+        jarr_set_all(&out);
+        break;
+    case jarr_par_op_clear_section:
+        jarr_clear_section(job->out, section_end - section_start,
+                           section_start);
+        break;
+    case jarr_par_op_set_section:
+        jarr_set_section(job->out, section_end - section_start,
+                         section_start);
+        break;
+    case jarr_par_op_popcount:
+        __atomic_fetch_add(&job->count, jarr_popcount(&out), __ATOMIC_RELAXED);
+        break;
+    case jarr_par_op_popcount_section:
+        __atomic_fetch_add(&job->count, jarr_popcount_section(job->in1,
+                           section_end - section_start, section_start),
+                           __ATOMIC_RELAXED);
+        break;
+    case jarr_par_op_add:
+        job->generate[chunk] = jarr_add(&out, &in1, &in2, 0);
+        job->propagate[chunk] = (jarr_find_next_clear(&out, 0)
+                == out.length_bits) ? 1 : 0;
+        break;
+    case jarr_par_op_increment:
+        if (job->carry[chunk] != 0)
+        {
+            jarr_element_t* element;
+            for (element = out.arr; element != out.limiter_element; ++element)
+            {
+                if (++*element != (jarr_element_t) 0)
+                {
+                    break;
+                }
+            }
+        }
+        break;
+    }
+}
+
+// takes chunks of the current job until there are none left
+
+static void jarr_pool_work(struct jarr_pool * const pool,
+                           struct jarr_par_job * const job)
+{
+    size_t chunk;
+    while ((chunk = __atomic_fetch_add(&pool->next_chunk, (size_t) 1U,
+                                       __ATOMIC_RELAXED)) < job->length_chunks)
+    {
+        jarr_par_run_chunk(job, chunk);
+    }
+}
+
+static void* jarr_pool_thread(void* const arg)
+{
+    struct jarr_pool * const pool = (struct jarr_pool*) arg;
+    unsigned long generation = 0;
+    pthread_mutex_lock(&pool->mutex);
+    for (;;)
+    {
+        while ((pool->stop == 0) && (pool->generation == generation))
+        {
+            pthread_cond_wait(&pool->start, &pool->mutex);
+        }
+        if (pool->stop != 0)
+        {
+            break;
+        }
+        generation = pool->generation;
+        struct jarr_par_job * const job = (struct jarr_par_job*) pool->job;
+        pthread_mutex_unlock(&pool->mutex);
+        jarr_pool_work(pool, job);
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->busy == (size_t) 0U)
+        {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+// starts threads threads, at most jarr_pool_max_threads. The calling thread
+// takes part in every operation, so a machine with n cores wants n - 1.
+// Returns 0 or an error number from pthreads, in which case there is no pool
+
+int jarr_pool_init(struct jarr_pool * const pool, size_t const threads)
+{
+    int error;
+    pool->length_threads = 0;
+    pool->serial_bytes = jarr_pool_serial_bytes;
+    pool->job = NULL;
+    pool->generation = 0;
+    pool->next_chunk = 0;
+    pool->busy = 0;
+    pool->stop = 0;
+    error = pthread_mutex_init(&pool->dispatch, NULL);
+    if (error != 0)
+    {
+        return error;
+    }
+    error = pthread_mutex_init(&pool->mutex, NULL);
+    if (error != 0)
+    {
+        pthread_mutex_destroy(&pool->dispatch);
+        return error;
+    }
+    error = pthread_cond_init(&pool->start, NULL);
+    if (error == 0)
+    {
+        error = pthread_cond_init(&pool->done, NULL);
+        if (error != 0)
+        {
+            pthread_cond_destroy(&pool->start);
+        }
+    }
+    if (error != 0)
+    {
+        pthread_mutex_destroy(&pool->mutex);
+        pthread_mutex_destroy(&pool->dispatch);
+        return error;
+    }
+    while ((pool->length_threads < threads)
+           && (pool->length_threads < jarr_pool_max_threads))
+    {
+        error = pthread_create(pool->threads + pool->length_threads, NULL,
+                               jarr_pool_thread, pool);
+        if (error != 0)
+        {
+            jarr_pool_destroy(pool);
+            return error;
+        }
+        ++pool->length_threads;
+    }
+    return 0;
+}
+
+// stops the threads
+
+void jarr_pool_destroy(struct jarr_pool * const pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->mutex);
+    size_t i;
+    for (i = 0; i < pool->length_threads; ++i)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pool->length_threads = 0;
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_mutex_destroy(&pool->dispatch);
+}
+
+// splits a job on elements first to first + length of j into chunks, a single
+// chunk if it is small or there is no pool
+
+static void jarr_pool_plan(struct jarr_pool const* const pool,
+                           struct jarr_par_job * const job,
+                           struct jarr const* const j, size_t const first,
+                           size_t const length)
+{
+    size_t const line = jarr_pool_cache_line / sizeof (jarr_element_t);
+    job->count = 0;
+    job->first = first;
+    job->length_elements = length;
+    job->head = length;
+    job->chunk_length = length;
+    job->length_chunks = (length != (size_t) 0U) ? 1U : 0U;
+
+    if ((pool != NULL) && (pool->length_threads != (size_t) 0U)
+        && (length * sizeof (jarr_element_t) >= pool->serial_bytes))
+    {
+        size_t const chunks = jarr_pool_chunks_per_thread
+                * (pool->length_threads + 1U);
+        job->head = ((jarr_pool_cache_line - ((uintptr_t) (j->arr + first)
+                % jarr_pool_cache_line)) % jarr_pool_cache_line)
+                / sizeof (jarr_element_t);
+        job->chunk_length = ((((length + chunks - 1U) / chunks) + line - 1U)
+                / line) * line;
+        job->length_chunks = (length > job->head) ? (length - job->head
+                + job->chunk_length - 1U) / job->chunk_length : 1U;
+    }
+}
+
+// runs every chunk of a planned job, a job at a time on each pool
+
+static void jarr_pool_dispatch(struct jarr_pool * const pool,
+                               struct jarr_par_job * const job)
+{
+    if (job->length_chunks <= (size_t) 1U)
+    {
+        if (job->length_chunks == (size_t) 1U)
+        {
+            jarr_par_run_chunk(job, 0);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->dispatch);
+    pthread_mutex_lock(&pool->mutex);
+    pool->job = job;
+    pool->next_chunk = 0;
+    pool->busy = pool->length_threads;
+    ++pool->generation;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->mutex);
+
+    jarr_pool_work(pool, job);
+
+    // every thread has to be done with the job before it goes out of scope
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->busy != (size_t) 0U)
+    {
+        pthread_cond_wait(&pool->done, &pool->mutex);
+    }
+    pool->job = NULL;
+    pthread_mutex_unlock(&pool->mutex);
+    pthread_mutex_unlock(&pool->dispatch);
+}
+
+static void jarr_pool_run(struct jarr_pool * const pool,
+                          struct jarr_par_job * const job,
+                          struct jarr const* const j, size_t const first,
+                          size_t const length)
+{
+    jarr_pool_plan(pool, job, j, first, length);
+    jarr_pool_dispatch(pool, job);
+}
+
+// runs an operation on every element of out
+
+static void jarr_par_op(struct jarr_pool * const pool, struct jarr * const out,
+                        struct jarr const* const in1,
+                        struct jarr const* const in2,
+                        enum jarr_par_op const op)
+{
+    struct jarr_par_job job = {
+        .op = op,
+        .out = out,
+        .in1 = in1,
+        .in2 = in2
+    };
+    jarr_pool_run(pool, &job, out, 0, out->length_elements);
+}
+
+// runs an operation on the elements holding a section
+
+static jarr_length_t jarr_par_section(struct jarr_pool * const pool,
+                                      struct jarr * const out,
+                                      struct jarr const* const in,
+                                      jarr_length_t const length,
+                                      jarr_length_t const startbit,
+                                      enum jarr_par_op const op)
+{
+    struct jarr_par_job job = {
+        .op = op,
+        .out = out,
+        .in1 = in,
+        .length = length,
+        .startbit = startbit
+    };
+    struct jarr const* const j = (out != NULL) ? out : in;
+    size_t const first = jarr_bitoei(startbit);
+    jarr_pool_run(pool, &job, j, first, (length != (jarr_length_t) 0U)
+                  ? jarr_bltoel(startbit + length) - first : 0);
+    return job.count;
+}
+
+void jarr_par_bw_and(struct jarr_pool * const pool, struct jarr * const out,
+                     struct jarr const* const in1,
+                     struct jarr const* const in2)
+{
+    jarr_par_op(pool, out, in1, in2, jarr_par_op_and);
+}
+
+void jarr_par_bw_or(struct jarr_pool * const pool, struct jarr * const out,
+                    struct jarr const* const in1,
+                    struct jarr const* const in2)
+{
+    jarr_par_op(pool, out, in1, in2, jarr_par_op_or);
+}
+
+void jarr_par_bw_xor(struct jarr_pool * const pool, struct jarr * const out,
+                     struct jarr const* const in1,
+                     struct jarr const* const in2)
+{
+    jarr_par_op(pool, out, in1, in2, jarr_par_op_xor);
+}
+
+void jarr_par_bw_andnot(struct jarr_pool * const pool, struct jarr * const out,
+                        struct jarr const* const in1,
+                        struct jarr const* const in2)
+{
+    jarr_par_op(pool, out, in1, in2, jarr_par_op_andnot);
+}
+
+void jarr_par_bw_not(struct jarr_pool * const pool, struct jarr * const out,
+                     struct jarr const* const in)
+{
+    jarr_par_op(pool, out, in, NULL, jarr_par_op_not);
+}
+
+void jarr_par_clear_all(struct jarr_pool * const pool, struct jarr * const j)
+{
+    jarr_par_op(pool, j, NULL, NULL, jarr_par_op_clear);
+}
+
+void jarr_par_set_all(struct jarr_pool * const pool, struct jarr * const j)
+{
+    jarr_par_op(pool, j, NULL, NULL, jarr_par_op_set);
+}
+
+void jarr_par_clear_section(struct jarr_pool * const pool,
+                            struct jarr * const j, jarr_length_t const length,
+                            jarr_length_t const startbit)
+{
+    jarr_par_section(pool, j, NULL, length, startbit,
+                     jarr_par_op_clear_section);
+}
+
+void jarr_par_set_section(struct jarr_pool * const pool, struct jarr * const j,
+                          jarr_length_t const length,
+                          jarr_length_t const startbit)
+{
+    jarr_par_section(pool, j, NULL, length, startbit, jarr_par_op_set_section);
+}
+
+jarr_length_t jarr_par_popcount(struct jarr_pool * const pool,
+                                struct jarr const* const j)
+{
+    struct jarr_par_job job = {
+        .op = jarr_par_op_popcount,
+        .in1 = j
+    };
+    jarr_pool_run(pool, &job, j, 0, j->length_elements);
+    return job.count;
+}
+
+jarr_length_t jarr_par_popcount_section(struct jarr_pool * const pool,
+                                        struct jarr const* const j,
+                                        jarr_length_t const length,
+                                        jarr_length_t const startbit)
+{
+    return jarr_par_section(pool, NULL, j, length, startbit,
+                            jarr_par_op_popcount_section);
+}
+
+// adds 2 jarrs as jarr_add does. Each chunk is added with no carry in, noting
+// whether it generates a carry and whether it is all ones and so would
+// propagate one. A pass over the chunks then finds each chunk's carry in, and
+// the chunks with one are incremented, which rarely goes past their first
+// element
+
+unsigned char jarr_par_add(struct jarr_pool * const pool,
+                           struct jarr * const out,
+                           struct jarr const* const in1,
+                           struct jarr const* const in2, unsigned char carry)
+{
+    struct jarr_par_job job = {
+        .op = jarr_par_op_add,
+        .out = out,
+        .in1 = in1,
+        .in2 = in2
+    };
+    jarr_pool_plan(pool, &job, out, 0, out->length_elements);
+    if (job.length_chunks <= (size_t) 1U)
+    {
+        return jarr_add(out, in1, in2, carry);
+    }
+    jarr_pool_dispatch(pool, &job);
+
+    size_t chunk;
+    for (chunk = 0; chunk < job.length_chunks; ++chunk)
+    {
+        job.carry[chunk] = carry;
+        carry = job.generate[chunk] | (carry & job.propagate[chunk]);
+    }
+    job.op = jarr_par_op_increment;
+    jarr_pool_dispatch(pool, &job);
+    return carry;
+}
@@ -0,0 +1,107 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_PARALLEL_H
+#define	JARR_PARALLEL_H
+
+#include "jarr.h"
+
+#include <pthread.h>
+#include <stdint.h>
+
+// bulk operations split between the threads of a reusable pool. The elements
+// are divided into chunks that start on cache line boundaries of the output,
+// so no two threads ever write to the same cache line, and the calling thread
+// works on chunks alongside the pool. Operations on fewer than serial_bytes
+// bytes run on the calling thread alone. A pool may be shared by several
+// threads, their operations take turns on it. Needs POSIX threads
+
+#define jarr_pool_max_threads 64
+#define jarr_pool_cache_line 64U
+// the chunks each thread gets, more balances the load better
+#define jarr_pool_chunks_per_thread 4U
+#define jarr_pool_max_chunks (jarr_pool_chunks_per_thread \
+    * (jarr_pool_max_threads + 1U) + 1U)
+
+#ifndef jarr_pool_serial_bytes
+#define jarr_pool_serial_bytes 262144U
+#endif
+
+struct jarr_pool
+{
+    pthread_t threads[jarr_pool_max_threads];
+    size_t length_threads;
+    // operations on fewer bytes than this run serially, may be changed at any
+    // time between operations
+    size_t serial_bytes;
+    // held by the thread running an operation on the pool for all of it
+    pthread_mutex_t dispatch;
+    pthread_mutex_t mutex;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    // the job being run and its chunks
+    void* job;
+    unsigned long generation;
+    size_t next_chunk;
+    // the threads yet to finish the job
+    size_t busy;
+    unsigned char stop;
+};
+
+int jarr_pool_init(struct jarr_pool * const pool, size_t const threads);
+void jarr_pool_destroy(struct jarr_pool * const pool);
+void jarr_par_bw_and(struct jarr_pool * const pool, struct jarr * const out,
+                     struct jarr const* const in1,
+                     struct jarr const* const in2);
+void jarr_par_bw_or(struct jarr_pool * const pool, struct jarr * const out,
+                    struct jarr const* const in1,
+                    struct jarr const* const in2);
+void jarr_par_bw_xor(struct jarr_pool * const pool, struct jarr * const out,
+                     struct jarr const* const in1,
+                     struct jarr const* const in2);
+void jarr_par_bw_andnot(struct jarr_pool * const pool, struct jarr * const out,
+                        struct jarr const* const in1,
+                        struct jarr const* const in2);
+void jarr_par_bw_not(struct jarr_pool * const pool, struct jarr * const out,
+                     struct jarr const* const in);
+void jarr_par_clear_all(struct jarr_pool * const pool, struct jarr * const j);
+void jarr_par_set_all(struct jarr_pool * const pool, struct jarr * const j);
+void jarr_par_clear_section(struct jarr_pool * const pool,
+                            struct jarr * const j, jarr_length_t const length,
+                            jarr_length_t const startbit);
+void jarr_par_set_section(struct jarr_pool * const pool, struct jarr * const j,
+                          jarr_length_t const length,
+                          jarr_length_t const startbit);
+unsigned char jarr_par_add(struct jarr_pool * const pool,
+                           struct jarr * const out,
+                           struct jarr const* const in1,
+                           struct jarr const* const in2, unsigned char carry);
+jarr_length_t jarr_par_popcount(struct jarr_pool * const pool,
+                                struct jarr const* const j);
+jarr_length_t jarr_par_popcount_section(struct jarr_pool * const pool,
+                                        struct jarr const* const j,
+                                        jarr_length_t const length,
+                                        jarr_length_t const startbit);
+
+#endif
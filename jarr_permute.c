@@ -0,0 +1,360 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr_permute.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define jarr_permute_bmi2 1
+#else
+#define jarr_permute_bmi2 0
+#endif
+
+// elements per 64 bit word
+
+#define jarr_permute_word_elements (64U / jarr_element_length)
+
+// bits (x) of a nibble under mask (m), indexed [m][x]
+
+static unsigned char const jarr_permute_extract[16][16] = {
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1},
+    {0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1},
+    {0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3},
+    {0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1},
+    {0, 1, 0, 1, 2, 3, 2, 3, 0, 1, 0, 1, 2, 3, 2, 3},
+    {0, 0, 1, 1, 2, 2, 3, 3, 0, 0, 1, 1, 2, 2, 3, 3},
+    {0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7},
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1},
+    {0, 1, 0, 1, 0, 1, 0, 1, 2, 3, 2, 3, 2, 3, 2, 3},
+    {0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 3, 3, 2, 2, 3, 3},
+    {0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 6, 7, 4, 5, 6, 7},
+    {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3},
+    {0, 1, 0, 1, 2, 3, 2, 3, 4, 5, 4, 5, 6, 7, 6, 7},
+    {0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}
+};
+
+static unsigned char const jarr_permute_deposit[16][16] = {
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1},
+    {0, 2, 0, 2, 0, 2, 0, 2, 0, 2, 0, 2, 0, 2, 0, 2},
+    {0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3},
+    {0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4, 0, 4},
+    {0, 1, 4, 5, 0, 1, 4, 5, 0, 1, 4, 5, 0, 1, 4, 5},
+    {0, 2, 4, 6, 0, 2, 4, 6, 0, 2, 4, 6, 0, 2, 4, 6},
+    {0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7},
+    {0, 8, 0, 8, 0, 8, 0, 8, 0, 8, 0, 8, 0, 8, 0, 8},
+    {0, 1, 8, 9, 0, 1, 8, 9, 0, 1, 8, 9, 0, 1, 8, 9},
+    {0, 2, 8, 10, 0, 2, 8, 10, 0, 2, 8, 10, 0, 2, 8, 10},
+    {0, 1, 2, 3, 8, 9, 10, 11, 0, 1, 2, 3, 8, 9, 10, 11},
+    {0, 4, 8, 12, 0, 4, 8, 12, 0, 4, 8, 12, 0, 4, 8, 12},
+    {0, 1, 4, 5, 8, 9, 12, 13, 0, 1, 4, 5, 8, 9, 12, 13},
+    {0, 2, 4, 6, 8, 10, 12, 14, 0, 2, 4, 6, 8, 10, 12, 14},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}
+};
+
+// the 64 bit word of j starting at bit 64 * word, the bits above length_bits
+// are cleared
+
+static uint64_t jarr_permute_load(struct jarr const* const j, size_t const word)
+{
+    size_t const first = word * jarr_permute_word_elements;
+    uint64_t w = 0;
+    size_t e;
+    for (e = 0; (e < jarr_permute_word_elements)
+            && (first + e < j->length_elements); ++e)
+    {
+        w |= (uint64_t) j->arr[first + e] << (e * jarr_element_length);
+    }
+    jarr_length_t const bits = j->length_bits - ((jarr_length_t) word * 64U);
+    return (bits < 64U) ? w & (((uint64_t) 1 << bits) - 1U) : w;
+}
+
+// stores the 64 bit word of j starting at bit 64 * word, as far as the
+// elements of j go
+
+static void jarr_permute_store(struct jarr * const j, size_t const word,
+                               uint64_t const w)
+{
+    size_t const first = word * jarr_permute_word_elements;
+    size_t e;
+    for (e = 0; (e < jarr_permute_word_elements)
+            && (first + e < j->length_elements); ++e)
+    {
+        j->arr[first + e] = (jarr_element_t) (w >> (e * jarr_element_length));
+    }
+}
+
+static unsigned int jarr_permute_popcount(uint64_t const w)
+{
+#if defined(__GNUC__)
+    return (unsigned int) __builtin_popcountll((unsigned long long) w);
+#else
+    unsigned int count = 0;
+    uint64_t v = w;
+    while (v != 0U)
+    {
+        v &= v - 1U;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+static size_t jarr_permute_words(struct jarr const* const j)
+{
+    return (size_t) ((j->length_bits + 63U) / 64U);
+}
+
+static uint64_t jarr_permute_pext_table(uint64_t const x, uint64_t const m)
+{
+    uint64_t r = 0;
+    unsigned int fill = 0;
+    unsigned int shift;
+    for (shift = 0; shift < 64U; shift += 4U)
+    {
+        unsigned int const mn = (unsigned int) (m >> shift) & 0xfU;
+        r |= (uint64_t) jarr_permute_extract[mn][(x >> shift) & 0xfU] << fill;
+        fill += jarr_permute_popcount(mn);
+    }
+    return r;
+}
+
+static uint64_t jarr_permute_pdep_table(uint64_t x, uint64_t const m)
+{
+    uint64_t r = 0;
+    unsigned int shift;
+    for (shift = 0; shift < 64U; shift += 4U)
+    {
+        unsigned int const mn = (unsigned int) (m >> shift) & 0xfU;
+        r |= (uint64_t) jarr_permute_deposit[mn][x & 0xfU] << shift;
+        x >>= jarr_permute_popcount(mn);
+    }
+    return r;
+}
+
+#if jarr_permute_bmi2 != 0
+
+__attribute__((target("bmi2"))) static uint64_t jarr_permute_pext_bmi2(
+        uint64_t const x, uint64_t const m)
+{
+    return _pext_u64(x, m);
+}
+
+__attribute__((target("bmi2"))) static uint64_t jarr_permute_pdep_bmi2(
+        uint64_t const x, uint64_t const m)
+{
+    return _pdep_u64(x, m);
+}
+
+static unsigned char jarr_permute_use_bmi2(void)
+{
+    __builtin_cpu_init();
+    return ((int) jarr_get_isa() >= (int) jarr_isa_avx2)
+            && __builtin_cpu_supports("bmi2");
+}
+
+#define jarr_permute_pext(x, m, bmi2) ((bmi2) ? jarr_permute_pext_bmi2((x), \
+        (m)) : jarr_permute_pext_table((x), (m)))
+#define jarr_permute_pdep(x, m, bmi2) ((bmi2) ? jarr_permute_pdep_bmi2((x), \
+        (m)) : jarr_permute_pdep_table((x), (m)))
+
+#else
+
+#define jarr_permute_use_bmi2() 0
+#define jarr_permute_pext(x, m, bmi2) jarr_permute_pext_table((x), (m))
+#define jarr_permute_pdep(x, m, bmi2) jarr_permute_pdep_table((x), (m))
+
+#endif
+
+// gathers the bits of in where mask is set into the bottom of out, in order,
+// and clears the rest of out. in and mask must be the same length, the result
+// is cut short if out is shorter than the number of set bits in mask, which is
+// returned
+
+jarr_length_t jarr_compress(struct jarr * const out,
+                            struct jarr const* const in,
+                            struct jarr const* const mask)
+{
+    unsigned char const bmi2 = jarr_permute_use_bmi2();
+    size_t const words = jarr_permute_words(mask);
+    size_t const out_words = jarr_permute_words(out);
+    size_t o = 0;
+    uint64_t acc = 0;
+    unsigned int fill = 0;
+    jarr_length_t total = 0;
+    size_t i;
+    for (i = 0; i < words; ++i)
+    {
+        uint64_t const m = jarr_permute_load(mask, i);
+        uint64_t const bits = jarr_permute_pext(jarr_permute_load(in, i), m,
+                                                bmi2);
+        unsigned int const count = jarr_permute_popcount(m);
+        total += count;
+        acc |= bits << fill;
+        if (fill + count >= 64U)
+        {
+            if (o < out_words)
+            {
+                jarr_permute_store(out, o, acc);
+            }
+            ++o;
+            acc = (fill != 0U) ? bits >> (64U - fill) : 0U;
+            fill = fill + count - 64U;
+        }
+        else
+        {
+            fill += count;
+        }
+    }
+    for (; o < out_words; ++o)
+    {
+        jarr_permute_store(out, o, acc);
+        acc = 0;
+    }
+    return total;
+}
+
+// spreads the bits at the bottom of in to where mask is set in out, in order,
+// and clears the rest of out. out and mask must be the same length and in must
+// hold at least as many bits as are set in mask
+
+void jarr_expand(struct jarr * const out, struct jarr const* const in,
+                 struct jarr const* const mask)
+{
+    unsigned char const bmi2 = jarr_permute_use_bmi2();
+    size_t const words = jarr_permute_words(mask);
+    size_t const in_words = jarr_permute_words(in);
+    // the next word of in and the bits of it left to deposit
+    size_t next = 0;
+    uint64_t acc = 0;
+    unsigned int fill = 0;
+    size_t i;
+    for (i = 0; i < words; ++i)
+    {
+        uint64_t const m = jarr_permute_load(mask, i);
+        unsigned int const count = jarr_permute_popcount(m);
+        uint64_t bits = acc;
+        if (count > fill)
+        {
+            // the next word of in goes above the bits left over, what is not
+            // deposited now is left over for the next word of out
+            uint64_t const w = (next < in_words) ? jarr_permute_load(in, next)
+                    : 0U;
+            ++next;
+            uint64_t const high = (fill != 0U) ? w >> (64U - fill) : 0U;
+            bits |= w << fill;
+            acc = (count < 64U) ? (bits >> count) | (high << (64U - count))
+                    : high;
+            fill = fill + 64U - count;
+        }
+        else
+        {
+            acc >>= count;
+            fill -= count;
+        }
+        jarr_permute_store(out, i, jarr_permute_pdep(bits, m, bmi2));
+    }
+}
+
+static uint64_t jarr_permute_bswap(uint64_t const w)
+{
+#if defined(__GNUC__)
+    return (uint64_t) __builtin_bswap64(w);
+#else
+    uint64_t r = 0;
+    unsigned int shift;
+    for (shift = 0; shift < 64U; shift += 8U)
+    {
+        r = (r << 8U) | ((w >> shift) & 0xffU);
+    }
+    return r;
+#endif
+}
+
+// the bits of an element in reverse order, by swapping ever larger groups
+
+static jarr_element_t jarr_permute_reverse_element(jarr_element_t const e)
+{
+    uint64_t w = (uint64_t) e;
+    w = ((w >> 1U) & 0x5555555555555555U) | ((w & 0x5555555555555555U) << 1U);
+    w = ((w >> 2U) & 0x3333333333333333U) | ((w & 0x3333333333333333U) << 2U);
+    w = ((w >> 4U) & 0x0f0f0f0f0f0f0f0fU) | ((w & 0x0f0f0f0f0f0f0f0fU) << 4U);
+    return (jarr_element_t) (jarr_permute_bswap(w) >> (64U
+            - jarr_element_length));
+}
+
+// out = in with its bits in reverse order, bit t of out is bit
+// length_bits - 1 - t of in. Both jarrs must be the same length, out may be in
+
+void jarr_reverse(struct jarr * const out, struct jarr const* const in)
+{
+    size_t const n = in->length_elements;
+    if (n == (size_t) 0U)
+    {
+        return;
+    }
+    // the elements are swapped end for end, so that out may be in
+    size_t lo = 0;
+    size_t hi = n - (size_t) 1U;
+    while (lo < hi)
+    {
+        jarr_element_t const a = jarr_permute_reverse_element(in->arr[lo]);
+        out->arr[lo] = jarr_permute_reverse_element(in->arr[hi]);
+        out->arr[hi] = a;
+        ++lo;
+        --hi;
+    }
+    if (lo == hi)
+    {
+        out->arr[lo] = jarr_permute_reverse_element(in->arr[lo]);
+    }
+    // the bits above length_bits in the last element of in are now at the
+    // bottom of out
+    jarr_length_t const pad = ((jarr_length_t) n * jarr_element_length)
+            - in->length_bits;
+    if (pad != (jarr_length_t) 0)
+    {
+        struct jarr whole = jarr_init(out->arr, (jarr_length_t) n
+                                      * jarr_element_length);
+        jarr_rshift(&whole, &whole, pad);
+    }
+}
+
+// out = in with the bytes of each element in reverse order, which converts
+// elements between little and big endian. Both jarrs must be the same length,
+// out may be in
+
+void jarr_byteswap(struct jarr * const out, struct jarr const* const in)
+{
+    size_t i;
+    for (i = 0; i < in->length_elements; ++i)
+    {
+        out->arr[i] = (jarr_element_t) (jarr_permute_bswap(
+                (uint64_t) in->arr[i]) >> (64U - jarr_element_length));
+    }
+}
@@ -0,0 +1,43 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_PERMUTE_H
+#define	JARR_PERMUTE_H
+
+#include "jarr.h"
+
+// operations that move bits to new positions. compress and expand work a 64
+// bit word at a time with the bmi2 pext and pdep instructions when the cpu has
+// them and the selected instruction set is at least avx2, otherwise a nibble
+// at a time from small tables
+
+jarr_length_t jarr_compress(struct jarr * const out,
+                            struct jarr const* const in,
+                            struct jarr const* const mask);
+void jarr_expand(struct jarr * const out, struct jarr const* const in,
+                 struct jarr const* const mask);
+void jarr_reverse(struct jarr * const out, struct jarr const* const in);
+void jarr_byteswap(struct jarr * const out, struct jarr const* const in);
+
+#endif
@@ -0,0 +1,201 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr_rank.h"
+
+#define jarr_rank_blocks_per_superblock (jarr_rank_superblock_bits \
+        / jarr_rank_block_bits)
+
+// the number of set bits in a block, the last block may be partial or empty
+
+static jarr_length_t jarr_rank_block_count(struct jarr const* const j,
+                                           size_t const block)
+{
+    jarr_length_t const startbit = (jarr_length_t) block
+            * jarr_rank_block_bits;
+    if (startbit >= j->length_bits)
+    {
+        return (jarr_length_t) 0U;
+    }
+    jarr_length_t const length = (j->length_bits - startbit
+            < jarr_rank_block_bits) ? j->length_bits - startbit
+            : jarr_rank_block_bits;
+    return jarr_popcount_section(j, length, startbit);
+}
+
+// recounts the blocks of a superblock, returns the number of set bits in it
+
+static jarr_length_t jarr_rank_count_superblock(struct jarr_rank * const r,
+                                                struct jarr const* const j,
+                                                size_t const superblock)
+{
+    size_t block = superblock * jarr_rank_blocks_per_superblock;
+    size_t limiter_block = block + jarr_rank_blocks_per_superblock;
+    if (limiter_block > r->length_blocks)
+    {
+        limiter_block = r->length_blocks;
+    }
+
+    jarr_length_t count = (jarr_length_t) 0U;
+    while (block < limiter_block)
+    {
+        r->blocks[block] = (uint16_t) count;
+        count += jarr_rank_block_count(j, block);
+        ++block;
+    }
+    return count;
+}
+
+// the position of the k-th (from 0) set bit of an element
+
+static jarr_element_length_t jarr_rank_select_element(jarr_element_t e,
+                                                      jarr_length_t k)
+{
+    while (k != (jarr_length_t) 0U)
+    {
+        e &= e - (jarr_element_t) 1;
+        --k;
+    }
+    return jarr_ctz_element(e);
+}
+
+struct jarr_rank jarr_rank_init(jarr_length_t * const _superblocks,
+                                uint16_t * const _blocks,
+                                struct jarr const* const j)
+{
+    struct jarr_rank r;
+    r.superblocks = _superblocks;
+    r.blocks = _blocks;
+    r.length_superblocks = jarr_rank_superblocks_length(j->length_bits);
+    r.length_blocks = jarr_rank_blocks_length(j->length_bits);
+
+    jarr_length_t count = (jarr_length_t) 0U;
+    size_t superblock;
+    for (superblock = 0; superblock < r.length_superblocks; ++superblock)
+    {
+        r.superblocks[superblock] = count;
+        count += jarr_rank_count_superblock(&r, j, superblock);
+    }
+    r.count = count;
+    return r;
+}
+
+// updates the directory after the section of length length starting at
+// startbit has been modified, only the superblocks covering the section are
+// recounted
+
+void jarr_rank_update(struct jarr_rank * const r, struct jarr const* const j,
+                      jarr_length_t const length, jarr_length_t const startbit)
+{
+    size_t superblock = startbit / jarr_rank_superblock_bits;
+    size_t const last_superblock = (startbit + length - (jarr_length_t) 1)
+            / jarr_rank_superblock_bits;
+
+    jarr_length_t count = r->superblocks[superblock];
+    while (superblock <= last_superblock)
+    {
+        r->superblocks[superblock] = count;
+        count += jarr_rank_count_superblock(r, j, superblock);
+        ++superblock;
+    }
+
+    // shift the absolute ranks of the untouched superblocks that follow
+    jarr_length_t const old_count = (superblock < r->length_superblocks)
+            ? r->superblocks[superblock] : r->count;
+    while (superblock < r->length_superblocks)
+    {
+        r->superblocks[superblock] = r->superblocks[superblock] - old_count
+                + count;
+        ++superblock;
+    }
+    r->count = r->count - old_count + count;
+}
+
+// the number of set bits before the bit at index bit, bit may be equal to
+// length_bits
+
+jarr_length_t jarr_rank(struct jarr_rank const* const r,
+                        struct jarr const* const j, jarr_length_t const bit)
+{
+    size_t const block = bit / jarr_rank_block_bits;
+    jarr_length_t const block_startbit = (jarr_length_t) block
+            * jarr_rank_block_bits;
+    jarr_length_t rank = r->superblocks[bit / jarr_rank_superblock_bits]
+            + r->blocks[block];
+    if (bit != block_startbit)
+    {
+        rank += jarr_popcount_section(j, bit - block_startbit, block_startbit);
+    }
+    return rank;
+}
+
+// the index of the k-th (from 0) set bit, k must be less than count
+
+jarr_length_t jarr_select(struct jarr_rank const* const r,
+                          struct jarr const* const j, jarr_length_t k)
+{
+    // the last superblock starting with k or fewer set bits before it
+    size_t low = 0;
+    size_t high = r->length_superblocks;
+    while (high - low > (size_t) 1U)
+    {
+        size_t const middle = low + ((high - low) / (size_t) 2U);
+        if (r->superblocks[middle] <= k)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    k -= r->superblocks[low];
+
+    // then the last block in it
+    size_t block = low * jarr_rank_blocks_per_superblock;
+    size_t limiter_block = block + jarr_rank_blocks_per_superblock;
+    if (limiter_block > r->length_blocks)
+    {
+        limiter_block = r->length_blocks;
+    }
+    while ((block + (size_t) 1U < limiter_block)
+           && (r->blocks[block + (size_t) 1U] <= k))
+    {
+        ++block;
+    }
+    k -= r->blocks[block];
+
+    // then scan the elements of the block
+    jarr_element_t const* element = j->arr + jarr_bitoei((jarr_length_t) block
+            * jarr_rank_block_bits);
+    jarr_length_t count = jarr_popcount_element(*element);
+    while (count <= k)
+    {
+        k -= count;
+        ++element;
+        count = jarr_popcount_element(*element);
+    }
+    return ((jarr_length_t) (element - j->arr) * jarr_element_length)
+            + jarr_rank_select_element(*element, k);
+}
@@ -0,0 +1,77 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_RANK_H
+#define	JARR_RANK_H
+
+#include "jarr.h"
+
+#include <stdint.h>
+
+// an auxiliary rank/select directory over a jarr. The absolute rank is stored
+// at the start of every superblock and the rank relative to the superblock at
+// the start of every block, which costs about 5% of the size of the jarr
+
+#define jarr_rank_block_bits 512
+#define jarr_rank_superblock_bits 4096
+
+struct jarr_rank
+{
+    // the number of set bits before the start of each superblock
+    jarr_length_t* superblocks;
+    // the number of set bits between the start of the superblock and the start
+    // of each block
+    uint16_t* blocks;
+    size_t length_superblocks;
+    size_t length_blocks;
+    // the total number of set bits
+    jarr_length_t count;
+};
+
+struct jarr_rank jarr_rank_init(jarr_length_t * const _superblocks,
+                                uint16_t * const _blocks,
+                                struct jarr const* const j);
+void jarr_rank_update(struct jarr_rank * const r, struct jarr const* const j,
+                      jarr_length_t const length, jarr_length_t const startbit);
+jarr_length_t jarr_rank(struct jarr_rank const* const r,
+                        struct jarr const* const j, jarr_length_t const bit);
+jarr_length_t jarr_select(struct jarr_rank const* const r,
+                          struct jarr const* const j, jarr_length_t const k);
+
+// the number of superblocks needed for a jarr of length bit_length
+
+inline static size_t jarr_rank_superblocks_length(jarr_length_t const
+                                                  bit_length)
+{
+    return (bit_length / jarr_rank_superblock_bits) + (size_t) 1U;
+}
+
+// the number of blocks needed for a jarr of length bit_length
+
+inline static size_t jarr_rank_blocks_length(jarr_length_t const bit_length)
+{
+    return (bit_length / jarr_rank_block_bits) + (size_t) 1U;
+}
+
+#endif
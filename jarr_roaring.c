@@ -0,0 +1,891 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr_roaring.h"
+
+#include <string.h>
+
+// the number of 64 bit words in an unpacked chunk
+
+#define jarr_roaring_words (jarr_roaring_chunk_bits / 64U)
+
+enum jarr_roaring_op
+{
+    jarr_roaring_op_and,
+    jarr_roaring_op_or,
+    jarr_roaring_op_xor,
+    jarr_roaring_op_andnot
+};
+
+#define jarr_roaring_apply(op, a, b) \
+    (((op) == jarr_roaring_op_and) ? ((a) & (b)) \
+    : ((op) == jarr_roaring_op_or) ? ((a) | (b)) \
+    : ((op) == jarr_roaring_op_xor) ? ((a) ^ (b)) : ((a) & ~(b)))
+
+struct jarr_roaring jarr_roaring_init(struct jarr_roaring_container *
+                                      const _containers,
+                                      size_t const _capacity_containers,
+                                      uint16_t * const _data,
+                                      size_t const _capacity_data,
+                                      jarr_length_t const _length_bits)
+{
+    struct jarr_roaring r = {
+        .containers = _containers,
+        .data = _data,
+        .length_containers = 0,
+        .capacity_containers = _capacity_containers,
+        .length_data = 0,
+        .capacity_data = _capacity_data,
+        .length_bits = _length_bits
+    };
+    return r;
+}
+
+// counts the set bits in a word of an unpacked chunk
+
+static uint32_t jarr_roaring_popcount_word(uint64_t w)
+{
+#if defined(__GNUC__)
+    return (uint32_t) __builtin_popcountll((unsigned long long) w);
+#else
+    uint32_t count = 0;
+    while (w != 0U)
+    {
+        w &= w - 1U;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// the index of the least significant set bit of a word, w must not be 0
+
+static uint32_t jarr_roaring_ctz_word(uint64_t w)
+{
+#if defined(__GNUC__)
+    return (uint32_t) __builtin_ctzll((unsigned long long) w);
+#else
+    uint32_t index = 0;
+    while ((w & 1U) == 0U)
+    {
+        w >>= 1U;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// sets length bits of an unpacked chunk from start
+
+static void jarr_roaring_set_range(uint64_t * const bits, uint32_t const start,
+                                   uint32_t const length)
+{
+    uint32_t const end = start + length;
+    uint32_t const first = start / 64U;
+    uint32_t const last = (end - 1U) / 64U;
+    uint64_t const first_mask = (uint64_t) - 1 << (start % 64U);
+    uint64_t const last_mask = (uint64_t) - 1 >> (63U - ((end - 1U) % 64U));
+    if (first == last)
+    {
+        bits[first] |= first_mask & last_mask;
+        return;
+    }
+    bits[first] |= first_mask;
+    uint32_t i;
+    for (i = first + 1U; i < last; ++i)
+    {
+        bits[i] = (uint64_t) - 1;
+    }
+    bits[last] |= last_mask;
+}
+
+// expands a container into an unpacked chunk
+
+static void jarr_roaring_unpack(uint64_t * const bits,
+                                struct jarr_roaring const* const r,
+                                struct jarr_roaring_container const* const c)
+{
+    uint16_t const* const data = r->data + c->offset;
+    size_t i;
+    memset(bits, 0, jarr_roaring_words * sizeof (*bits));
+    switch (c->type)
+    {
+    case jarr_roaring_array:
+        for (i = 0; i < c->length; ++i)
+        {
+            bits[data[i] / 64U] |= (uint64_t) 1 << (data[i] % 64U);
+        }
+        break;
+    case jarr_roaring_bitmap:
+        for (i = 0; i < jarr_roaring_words; ++i)
+        {
+            bits[i] = (uint64_t) data[4U * i]
+                    | ((uint64_t) data[(4U * i) + 1U] << 16U)
+                    | ((uint64_t) data[(4U * i) + 2U] << 32U)
+                    | ((uint64_t) data[(4U * i) + 3U] << 48U);
+        }
+        break;
+    case jarr_roaring_run:
+        for (i = 0; i < c->length; i += 2U)
+        {
+            jarr_roaring_set_range(bits, data[i], (uint32_t) data[i + 1U] + 1U);
+        }
+        break;
+    }
+}
+
+// reserves a container at the end of a bitmap, returns its words or NULL if
+// the bitmap is out of space
+
+static uint16_t * jarr_roaring_append(struct jarr_roaring * const r,
+                                      jarr_length_t const key,
+                                      enum jarr_roaring_type const type,
+                                      size_t const length,
+                                      uint32_t const cardinality)
+{
+    if ((r->length_containers == r->capacity_containers)
+        || (r->capacity_data - r->length_data < length))
+    {
+        return NULL;
+    }
+    struct jarr_roaring_container * const c = r->containers
+            + r->length_containers;
+    c->key = key;
+    c->offset = r->length_data;
+    c->length = length;
+    c->cardinality = cardinality;
+    c->type = type;
+    ++r->length_containers;
+    r->length_data += length;
+    return r->data + c->offset;
+}
+
+// appends an array container
+
+static unsigned char jarr_roaring_append_array(struct jarr_roaring * const r,
+                                               jarr_length_t const key,
+                                               uint16_t const* const values,
+                                               size_t const length)
+{
+    if (length == (size_t) 0U)
+    {
+        return 0;
+    }
+    uint16_t * const data = jarr_roaring_append(r, key, jarr_roaring_array,
+                                                length, (uint32_t) length);
+    if (data == NULL)
+    {
+        return 1;
+    }
+    memcpy(data, values, length * sizeof (*data));
+    return 0;
+}
+
+// appends a copy of another bitmap's container
+
+static unsigned char jarr_roaring_append_copy(struct jarr_roaring * const r,
+                                              struct jarr_roaring const* const in,
+                                              struct jarr_roaring_container
+                                              const* const c)
+{
+    uint16_t * const data = jarr_roaring_append(r, c->key, c->type, c->length,
+                                                c->cardinality);
+    if (data == NULL)
+    {
+        return 1;
+    }
+    memcpy(data, in->data + c->offset, c->length * sizeof (*data));
+    return 0;
+}
+
+// the index of the first bit at or after bit that is set, or clear if flip is
+// all ones, or the chunk length if there is none
+
+static uint32_t jarr_roaring_next(uint64_t const* const bits, uint32_t const bit,
+                                  uint64_t const flip)
+{
+    uint32_t word = bit / 64U;
+    if (word == jarr_roaring_words)
+    {
+        return jarr_roaring_chunk_bits;
+    }
+    uint64_t w = (bits[word] ^ flip) & ((uint64_t) - 1 << (bit % 64U));
+    while (w == 0U)
+    {
+        if (++word == jarr_roaring_words)
+        {
+            return jarr_roaring_chunk_bits;
+        }
+        w = bits[word] ^ flip;
+    }
+    return (word * 64U) + jarr_roaring_ctz_word(w);
+}
+
+// appends an unpacked chunk as whichever container is smallest, nothing is
+// appended if it is empty
+
+static unsigned char jarr_roaring_pack(struct jarr_roaring * const r,
+                                       jarr_length_t const key,
+                                       uint64_t const* const bits)
+{
+    uint32_t cardinality = 0;
+    size_t runs = 0;
+    uint64_t carry = 0;
+    size_t i;
+    for (i = 0; i < jarr_roaring_words; ++i)
+    {
+        cardinality += jarr_roaring_popcount_word(bits[i]);
+        // a run starts wherever a set bit follows a clear one
+        uint64_t const starts = bits[i] & ~((bits[i] << 1U) | carry);
+        runs += (size_t) jarr_roaring_popcount_word(starts);
+        carry = bits[i] >> 63U;
+    }
+    if (cardinality == 0U)
+    {
+        return 0;
+    }
+
+    size_t const array_length = (cardinality <= jarr_roaring_array_max)
+            ? cardinality : jarr_roaring_bitmap_length;
+    uint16_t * data;
+    if (2U * runs < array_length)
+    {
+        data = jarr_roaring_append(r, key, jarr_roaring_run, 2U * runs,
+                                   cardinality);
+        if (data == NULL)
+        {
+            return 1;
+        }
+        uint32_t start = jarr_roaring_next(bits, 0, 0);
+        while (start != jarr_roaring_chunk_bits)
+        {
+            uint32_t const end = jarr_roaring_next(bits, start, (uint64_t) - 1);
+            *data++ = (uint16_t) start;
+            *data++ = (uint16_t) (end - start - 1U);
+            start = jarr_roaring_next(bits, end, 0);
+        }
+    }
+    else if (cardinality <= jarr_roaring_array_max)
+    {
+        data = jarr_roaring_append(r, key, jarr_roaring_array, cardinality,
+                                   cardinality);
+        if (data == NULL)
+        {
+            return 1;
+        }
+        for (i = 0; i < jarr_roaring_words; ++i)
+        {
+            uint64_t w = bits[i];
+            while (w != 0U)
+            {
+                *data++ = (uint16_t) ((i * 64U)
+                                      + (size_t) jarr_roaring_ctz_word(w));
+                w &= w - 1U;
+            }
+        }
+    }
+    else
+    {
+        data = jarr_roaring_append(r, key, jarr_roaring_bitmap,
+                                   jarr_roaring_bitmap_length, cardinality);
+        if (data == NULL)
+        {
+            return 1;
+        }
+        for (i = 0; i < jarr_roaring_words; ++i)
+        {
+            data[4U * i] = (uint16_t) bits[i];
+            data[(4U * i) + 1U] = (uint16_t) (bits[i] >> 16U);
+            data[(4U * i) + 2U] = (uint16_t) (bits[i] >> 32U);
+            data[(4U * i) + 3U] = (uint16_t) (bits[i] >> 48U);
+        }
+    }
+    return 0;
+}
+
+// loads the chunk of a jarr at key into an unpacked chunk, chunks are always
+// element aligned
+
+static void jarr_roaring_load(uint64_t * const bits, struct jarr const* const j,
+                              jarr_length_t const key)
+{
+    size_t const first = (size_t) (key * (jarr_length_t) (jarr_roaring_chunk_bits
+                                   / jarr_element_length));
+    size_t end = first + (size_t) (jarr_roaring_chunk_bits
+            / jarr_element_length);
+    if (end > j->length_elements)
+    {
+        end = j->length_elements;
+    }
+    memset(bits, 0, jarr_roaring_words * sizeof (*bits));
+    size_t e;
+    for (e = first; e < end; ++e)
+    {
+        uint64_t const v = (e == j->length_elements - (size_t) 1U)
+                ? (uint64_t) jarr_get_lev(j) : (uint64_t) j->arr[e];
+        size_t const bit = (e - first) * jarr_element_length;
+        bits[bit / 64U] |= v << (bit % 64U);
+    }
+}
+
+// out = in1 op bits over the chunk at key
+
+static void jarr_roaring_store(struct jarr * const out,
+                               struct jarr const* const in1,
+                               uint64_t const* const bits,
+                               jarr_length_t const key,
+                               enum jarr_roaring_op const op)
+{
+    size_t const first = (size_t) (key * (jarr_length_t) (jarr_roaring_chunk_bits
+                                   / jarr_element_length));
+    size_t end = first + (size_t) (jarr_roaring_chunk_bits
+            / jarr_element_length);
+    if (end > out->length_elements)
+    {
+        end = out->length_elements;
+    }
+    size_t e;
+    for (e = first; e < end; ++e)
+    {
+        size_t const bit = (e - first) * jarr_element_length;
+        jarr_element_t const v = (jarr_element_t) (bits[bit / 64U]
+                >> (bit % 64U));
+        out->arr[e] = jarr_roaring_apply(op, in1->arr[e], v);
+    }
+}
+
+// keeps the values of an array container whose bits in an unpacked chunk are
+// set, or clear if flip is all ones
+
+static unsigned char jarr_roaring_filter(struct jarr_roaring * const out,
+                                         jarr_length_t const key,
+                                         uint16_t const* const values,
+                                         size_t const length,
+                                         uint64_t const* const bits,
+                                         uint64_t const flip)
+{
+    uint16_t kept[jarr_roaring_array_max];
+    size_t length_kept = 0;
+    size_t i;
+    for (i = 0; i < length; ++i)
+    {
+        kept[length_kept] = values[i];
+        length_kept += (size_t) (((bits[values[i] / 64U] ^ flip)
+                >> (values[i] % 64U)) & 1U);
+    }
+    return jarr_roaring_append_array(out, key, kept, length_kept);
+}
+
+// merges 2 array containers
+
+static unsigned char jarr_roaring_merge(struct jarr_roaring * const out,
+                                        jarr_length_t const key,
+                                        uint16_t const* const a,
+                                        size_t const length_a,
+                                        uint16_t const* const b,
+                                        size_t const length_b,
+                                        enum jarr_roaring_op const op)
+{
+    uint16_t merged[2U * jarr_roaring_array_max];
+    size_t length = 0;
+    size_t i = 0;
+    size_t k = 0;
+    while ((i < length_a) && (k < length_b))
+    {
+        if (a[i] < b[k])
+        {
+            merged[length] = a[i++];
+            length += (op != jarr_roaring_op_and) ? 1U : 0U;
+        }
+        else if (b[k] < a[i])
+        {
+            merged[length] = b[k++];
+            length += ((op == jarr_roaring_op_or) || (op == jarr_roaring_op_xor))
+                    ? 1U : 0U;
+        }
+        else
+        {
+            merged[length] = a[i++];
+            ++k;
+            length += ((op == jarr_roaring_op_and) || (op == jarr_roaring_op_or))
+                    ? 1U : 0U;
+        }
+    }
+    if (op != jarr_roaring_op_and)
+    {
+        while (i < length_a)
+        {
+            merged[length++] = a[i++];
+        }
+    }
+    if ((op == jarr_roaring_op_or) || (op == jarr_roaring_op_xor))
+    {
+        while (k < length_b)
+        {
+            merged[length++] = b[k++];
+        }
+    }
+
+    if (length <= jarr_roaring_array_max)
+    {
+        return jarr_roaring_append_array(out, key, merged, length);
+    }
+    uint64_t bits[jarr_roaring_words];
+    memset(bits, 0, sizeof (bits));
+    for (i = 0; i < length; ++i)
+    {
+        bits[merged[i] / 64U] |= (uint64_t) 1 << (merged[i] % 64U);
+    }
+    return jarr_roaring_pack(out, key, bits);
+}
+
+// combines 2 containers with the same key
+
+static unsigned char jarr_roaring_combine(struct jarr_roaring * const out,
+                                          struct jarr_roaring const* const in1,
+                                          struct jarr_roaring_container
+                                          const* const c1,
+                                          struct jarr_roaring const* const in2,
+                                          struct jarr_roaring_container
+                                          const* const c2,
+                                          enum jarr_roaring_op const op)
+{
+    uint16_t const* const data1 = in1->data + c1->offset;
+    uint16_t const* const data2 = in2->data + c2->offset;
+    uint64_t bits1[jarr_roaring_words];
+    uint64_t bits2[jarr_roaring_words];
+
+    if ((c1->type == jarr_roaring_array) && (c2->type == jarr_roaring_array))
+    {
+        return jarr_roaring_merge(out, c1->key, data1, c1->length, data2,
+                                  c2->length, op);
+    }
+    // the result of an intersection or difference with an array is at most
+    // as long as the array
+    if ((c1->type == jarr_roaring_array) && ((op == jarr_roaring_op_and)
+                                             || (op == jarr_roaring_op_andnot)))
+    {
+        jarr_roaring_unpack(bits2, in2, c2);
+        return jarr_roaring_filter(out, c1->key, data1, c1->length, bits2,
+                                   (op == jarr_roaring_op_and) ? 0
+                                   : (uint64_t) - 1);
+    }
+    if ((c2->type == jarr_roaring_array) && (op == jarr_roaring_op_and))
+    {
+        jarr_roaring_unpack(bits1, in1, c1);
+        return jarr_roaring_filter(out, c1->key, data2, c2->length, bits1, 0);
+    }
+
+    jarr_roaring_unpack(bits1, in1, c1);
+    jarr_roaring_unpack(bits2, in2, c2);
+    size_t i;
+    for (i = 0; i < jarr_roaring_words; ++i)
+    {
+        bits1[i] = jarr_roaring_apply(op, bits1[i], bits2[i]);
+    }
+    return jarr_roaring_pack(out, c1->key, bits1);
+}
+
+// out = in1 op in2, walking the containers of both in key order
+
+static unsigned char jarr_roaring_op(struct jarr_roaring * const out,
+                                     struct jarr_roaring const* const in1,
+                                     struct jarr_roaring const* const in2,
+                                     enum jarr_roaring_op const op)
+{
+    size_t i1 = 0;
+    size_t i2 = 0;
+    out->length_containers = 0;
+    out->length_data = 0;
+    out->length_bits = in1->length_bits;
+
+    while ((i1 < in1->length_containers) || (i2 < in2->length_containers))
+    {
+        struct jarr_roaring_container const* const c1 = (i1
+                < in1->length_containers) ? in1->containers + i1 : NULL;
+        struct jarr_roaring_container const* const c2 = (i2
+                < in2->length_containers) ? in2->containers + i2 : NULL;
+        unsigned char fail = 0;
+
+        if ((c2 == NULL) || ((c1 != NULL) && (c1->key < c2->key)))
+        {
+            if (op == jarr_roaring_op_and)
+            {
+                if (c2 == NULL)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                fail = jarr_roaring_append_copy(out, in1, c1);
+            }
+            ++i1;
+        }
+        else if ((c1 == NULL) || (c2->key < c1->key))
+        {
+            if ((op == jarr_roaring_op_or) || (op == jarr_roaring_op_xor))
+            {
+                fail = jarr_roaring_append_copy(out, in2, c2);
+            }
+            else if (c1 == NULL)
+            {
+                break;
+            }
+            ++i2;
+        }
+        else
+        {
+            fail = jarr_roaring_combine(out, in1, c1, in2, c2, op);
+            ++i1;
+            ++i2;
+        }
+        if (fail != 0)
+        {
+            return fail;
+        }
+    }
+    return 0;
+}
+
+// out = in1 op in2 for a dense in2, only in1's containers can be in out
+
+static unsigned char jarr_roaring_op_jarr(struct jarr_roaring * const out,
+                                          struct jarr_roaring const* const in1,
+                                          struct jarr const* const in2,
+                                          enum jarr_roaring_op const op)
+{
+    uint64_t bits1[jarr_roaring_words];
+    uint64_t bits2[jarr_roaring_words];
+    out->length_containers = 0;
+    out->length_data = 0;
+    out->length_bits = in1->length_bits;
+
+    size_t i;
+    for (i = 0; i < in1->length_containers; ++i)
+    {
+        struct jarr_roaring_container const* const c = in1->containers + i;
+        unsigned char fail;
+        jarr_roaring_load(bits2, in2, c->key);
+        if (c->type == jarr_roaring_array)
+        {
+            fail = jarr_roaring_filter(out, c->key, in1->data + c->offset,
+                                       c->length, bits2, (op
+                                       == jarr_roaring_op_and) ? 0
+                                       : (uint64_t) - 1);
+        }
+        else
+        {
+            jarr_roaring_unpack(bits1, in1, c);
+            size_t k;
+            for (k = 0; k < jarr_roaring_words; ++k)
+            {
+                bits1[k] = jarr_roaring_apply(op, bits1[k], bits2[k]);
+            }
+            fail = jarr_roaring_pack(out, c->key, bits1);
+        }
+        if (fail != 0)
+        {
+            return fail;
+        }
+    }
+    return 0;
+}
+
+// out = in1 op in2 for a dense out and in1, chunks without a container are
+// copied or cleared
+
+static void jarr_roaring_bw_op(struct jarr * const out,
+                               struct jarr const* const in1,
+                               struct jarr_roaring const* const in2,
+                               enum jarr_roaring_op const op)
+{
+    uint64_t bits[jarr_roaring_words];
+    size_t const elements_per_chunk = (size_t) (jarr_roaring_chunk_bits
+            / jarr_element_length);
+    struct jarr_roaring_container const* c = in2->containers;
+    struct jarr_roaring_container const* const end = in2->containers
+            + in2->length_containers;
+    jarr_length_t key;
+    for (key = 0; key < jarr_roaring_containers_length(out->length_bits);
+         ++key)
+    {
+        size_t const first = (size_t) key * elements_per_chunk;
+        size_t last = first + elements_per_chunk;
+        if (last > out->length_elements)
+        {
+            last = out->length_elements;
+        }
+        while ((c != end) && (c->key < key))
+        {
+            ++c;
+        }
+
+        if ((c == end) || (c->key != key))
+        {
+            if (op == jarr_roaring_op_and)
+            {
+                memset(out->arr + first, 0, (last - first)
+                       * sizeof (jarr_element_t));
+            }
+            else if (out != in1)
+            {
+                memcpy(out->arr + first, in1->arr + first, (last - first)
+                       * sizeof (jarr_element_t));
+            }
+        }
+        else if ((c->type == jarr_roaring_array) && (op != jarr_roaring_op_and))
+        {
+            // an array touches few enough bits to apply one at a time
+            if (out != in1)
+            {
+                memcpy(out->arr + first, in1->arr + first, (last - first)
+                       * sizeof (jarr_element_t));
+            }
+            uint16_t const* const data = in2->data + c->offset;
+            jarr_length_t const start = key * jarr_roaring_chunk_bits;
+            size_t i;
+            for (i = 0; i < c->length; ++i)
+            {
+                switch (op)
+                {
+                case jarr_roaring_op_or:
+                    jarr_set(out, start + data[i]);
+                    break;
+                case jarr_roaring_op_xor:
+                    jarr_toggle(out, start + data[i]);
+                    break;
+                default:
+                    jarr_clear(out, start + data[i]);
+                    break;
+                }
+            }
+        }
+        else
+        {
+            jarr_roaring_unpack(bits, in2, c);
+            jarr_roaring_store(out, in1, bits, key, op);
+        }
+    }
+}
+
+// compresses a jarr, returns 0 or 1 if out ran out of space
+
+unsigned char jarr_roaring_from_jarr(struct jarr_roaring * const out,
+                                     struct jarr const* const in)
+{
+    uint64_t bits[jarr_roaring_words];
+    out->length_containers = 0;
+    out->length_data = 0;
+    out->length_bits = in->length_bits;
+    jarr_length_t key;
+    for (key = 0; key < jarr_roaring_containers_length(in->length_bits); ++key)
+    {
+        jarr_roaring_load(bits, in, key);
+        if (jarr_roaring_pack(out, key, bits) != 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// decompresses into a jarr of the same length
+
+void jarr_roaring_to_jarr(struct jarr * const out,
+                          struct jarr_roaring const* const in)
+{
+    uint64_t bits[jarr_roaring_words];
+    jarr_clear_all(out);
+    size_t i;
+    for (i = 0; i < in->length_containers; ++i)
+    {
+        struct jarr_roaring_container const* const c = in->containers + i;
+        uint16_t const* const data = in->data + c->offset;
+        jarr_length_t const start = c->key * jarr_roaring_chunk_bits;
+        size_t k;
+        switch (c->type)
+        {
+        case jarr_roaring_array:
+            for (k = 0; k < c->length; ++k)
+            {
+                jarr_set(out, start + data[k]);
+            }
+            break;
+        case jarr_roaring_run:
+            for (k = 0; k < c->length; k += 2U)
+            {
+                jarr_set_section(out, (jarr_length_t) data[k + 1U] + 1U,
+                                 start + data[k]);
+            }
+            break;
+        default:
+            jarr_roaring_unpack(bits, in, c);
+            jarr_roaring_store(out, out, bits, c->key, jarr_roaring_op_or);
+            break;
+        }
+    }
+}
+
+// reads a bit
+
+unsigned char jarr_roaring_read(struct jarr_roaring const* const r,
+                                jarr_length_t const bit)
+{
+    jarr_length_t const key = bit / jarr_roaring_chunk_bits;
+    uint16_t const value = (uint16_t) (bit % jarr_roaring_chunk_bits);
+
+    // the last container with a key not greater than key
+    size_t low = 0;
+    size_t high = r->length_containers;
+    while (low < high)
+    {
+        size_t const mid = low + ((high - low) / 2U);
+        if (r->containers[mid].key <= key)
+        {
+            low = mid + 1U;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    if ((low == (size_t) 0U) || (r->containers[low - 1U].key != key))
+    {
+        return 0;
+    }
+    struct jarr_roaring_container const* const c = r->containers + low - 1U;
+    uint16_t const* const data = r->data + c->offset;
+
+    if (c->type == jarr_roaring_bitmap)
+    {
+        return (unsigned char) ((data[value / 16U] >> (value % 16U)) & 1U);
+    }
+    // the last value or run start not greater than value
+    size_t const stride = (c->type == jarr_roaring_run) ? 2U : 1U;
+    low = 0;
+    high = c->length / stride;
+    while (low < high)
+    {
+        size_t const mid = low + ((high - low) / 2U);
+        if (data[mid * stride] <= value)
+        {
+            low = mid + 1U;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    if (low == (size_t) 0U)
+    {
+        return 0;
+    }
+    uint16_t const* const found = data + ((low - 1U) * stride);
+    if (c->type == jarr_roaring_array)
+    {
+        return (*found == value) ? 1 : 0;
+    }
+    return ((uint32_t) (value - found[0]) <= found[1]) ? 1 : 0;
+}
+
+// counts the set bits
+
+jarr_length_t jarr_roaring_popcount(struct jarr_roaring const* const r)
+{
+    jarr_length_t count = 0;
+    size_t i;
+    for (i = 0; i < r->length_containers; ++i)
+    {
+        count += r->containers[i].cardinality;
+    }
+    return count;
+}
+
+unsigned char jarr_roaring_and(struct jarr_roaring * const out,
+                               struct jarr_roaring const* const in1,
+                               struct jarr_roaring const* const in2)
+{
+    return jarr_roaring_op(out, in1, in2, jarr_roaring_op_and);
+}
+
+unsigned char jarr_roaring_or(struct jarr_roaring * const out,
+                              struct jarr_roaring const* const in1,
+                              struct jarr_roaring const* const in2)
+{
+    return jarr_roaring_op(out, in1, in2, jarr_roaring_op_or);
+}
+
+unsigned char jarr_roaring_xor(struct jarr_roaring * const out,
+                               struct jarr_roaring const* const in1,
+                               struct jarr_roaring const* const in2)
+{
+    return jarr_roaring_op(out, in1, in2, jarr_roaring_op_xor);
+}
+
+unsigned char jarr_roaring_andnot(struct jarr_roaring * const out,
+                                  struct jarr_roaring const* const in1,
+                                  struct jarr_roaring const* const in2)
+{
+    return jarr_roaring_op(out, in1, in2, jarr_roaring_op_andnot);
+}
+
+unsigned char jarr_roaring_and_jarr(struct jarr_roaring * const out,
+                                    struct jarr_roaring const* const in1,
+                                    struct jarr const* const in2)
+{
+    return jarr_roaring_op_jarr(out, in1, in2, jarr_roaring_op_and);
+}
+
+unsigned char jarr_roaring_andnot_jarr(struct jarr_roaring * const out,
+                                       struct jarr_roaring const* const in1,
+                                       struct jarr const* const in2)
+{
+    return jarr_roaring_op_jarr(out, in1, in2, jarr_roaring_op_andnot);
+}
+
+void jarr_bw_and_roaring(struct jarr * const out, struct jarr const* const in1,
+                         struct jarr_roaring const* const in2)
+{
+    jarr_roaring_bw_op(out, in1, in2, jarr_roaring_op_and);
+}
+
+void jarr_bw_or_roaring(struct jarr * const out, struct jarr const* const in1,
+                        struct jarr_roaring const* const in2)
+{
+    jarr_roaring_bw_op(out, in1, in2, jarr_roaring_op_or);
+}
+
+void jarr_bw_xor_roaring(struct jarr * const out, struct jarr const* const in1,
+                         struct jarr_roaring const* const in2)
+{
+    jarr_roaring_bw_op(out, in1, in2, jarr_roaring_op_xor);
+}
+
+void jarr_bw_andnot_roaring(struct jarr * const out,
+                            struct jarr const* const in1,
+                            struct jarr_roaring const* const in2)
+{
+    jarr_roaring_bw_op(out, in1, in2, jarr_roaring_op_andnot);
+}
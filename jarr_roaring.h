@@ -0,0 +1,135 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_ROARING_H
+#define	JARR_ROARING_H
+
+#include "jarr.h"
+
+#include <stdint.h>
+
+// a compressed bitmap in the style of roaring bitmaps. The bit indices are
+// split into chunks of 65536 bits, each chunk with any set bits has a container
+// holding the low 16 bits of its set bits as a sorted array, a bitmap or a
+// sorted list of runs, whichever is smallest. The containers and their data
+// are stored in caller provided buffers
+
+#define jarr_roaring_chunk_bits 65536U
+// the most values an array container holds, past this a bitmap is smaller
+#define jarr_roaring_array_max 4096U
+// the length of a bitmap container in 16 bit words
+#define jarr_roaring_bitmap_length (jarr_roaring_chunk_bits / 16U)
+
+enum jarr_roaring_type
+{
+    jarr_roaring_array,
+    jarr_roaring_bitmap,
+    jarr_roaring_run
+};
+
+struct jarr_roaring_container
+{
+    // the bit index of the start of the chunk divided by the chunk length
+    jarr_length_t key;
+    // the offset of the container's words in the data buffer
+    size_t offset;
+    // the number of words, for a run container each run is a word for the
+    // start and a word for the length - 1
+    size_t length;
+    // the number of set bits, 1 to 65536
+    uint32_t cardinality;
+    enum jarr_roaring_type type;
+};
+
+struct jarr_roaring
+{
+    // sorted by key
+    struct jarr_roaring_container* containers;
+    uint16_t* data;
+    size_t length_containers;
+    size_t capacity_containers;
+    size_t length_data;
+    size_t capacity_data;
+    jarr_length_t length_bits;
+};
+
+struct jarr_roaring jarr_roaring_init(struct jarr_roaring_container *
+                                      const _containers,
+                                      size_t const _capacity_containers,
+                                      uint16_t * const _data,
+                                      size_t const _capacity_data,
+                                      jarr_length_t const _length_bits);
+unsigned char jarr_roaring_from_jarr(struct jarr_roaring * const out,
+                                     struct jarr const* const in);
+void jarr_roaring_to_jarr(struct jarr * const out,
+                          struct jarr_roaring const* const in);
+unsigned char jarr_roaring_read(struct jarr_roaring const* const r,
+                                jarr_length_t const bit);
+jarr_length_t jarr_roaring_popcount(struct jarr_roaring const* const r);
+unsigned char jarr_roaring_and(struct jarr_roaring * const out,
+                               struct jarr_roaring const* const in1,
+                               struct jarr_roaring const* const in2);
+unsigned char jarr_roaring_or(struct jarr_roaring * const out,
+                              struct jarr_roaring const* const in1,
+                              struct jarr_roaring const* const in2);
+unsigned char jarr_roaring_xor(struct jarr_roaring * const out,
+                               struct jarr_roaring const* const in1,
+                               struct jarr_roaring const* const in2);
+unsigned char jarr_roaring_andnot(struct jarr_roaring * const out,
+                                  struct jarr_roaring const* const in1,
+                                  struct jarr_roaring const* const in2);
+unsigned char jarr_roaring_and_jarr(struct jarr_roaring * const out,
+                                    struct jarr_roaring const* const in1,
+                                    struct jarr const* const in2);
+unsigned char jarr_roaring_andnot_jarr(struct jarr_roaring * const out,
+                                       struct jarr_roaring const* const in1,
+                                       struct jarr const* const in2);
+void jarr_bw_and_roaring(struct jarr * const out, struct jarr const* const in1,
+                         struct jarr_roaring const* const in2);
+void jarr_bw_or_roaring(struct jarr * const out, struct jarr const* const in1,
+                        struct jarr_roaring const* const in2);
+void jarr_bw_xor_roaring(struct jarr * const out, struct jarr const* const in1,
+                         struct jarr_roaring const* const in2);
+void jarr_bw_andnot_roaring(struct jarr * const out,
+                            struct jarr const* const in1,
+                            struct jarr_roaring const* const in2);
+
+// the number of containers always enough for a bitmap of length bit_length
+
+inline static size_t jarr_roaring_containers_length(jarr_length_t const
+                                                    bit_length)
+{
+    return (size_t) ((bit_length + jarr_roaring_chunk_bits - 1U)
+            / jarr_roaring_chunk_bits);
+}
+
+// the number of data words always enough for a bitmap of length bit_length
+
+inline static size_t jarr_roaring_data_length(jarr_length_t const bit_length)
+{
+    return jarr_roaring_containers_length(bit_length)
+            * jarr_roaring_bitmap_length;
+}
+
+#endif
@@ -0,0 +1,915 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr_simd.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define jarr_simd_x86 1
+#else
+#define jarr_simd_x86 0
+#endif
+
+#if jarr_simd_x86 != 0
+#include <immintrin.h>
+
+#define jarr_simd_target_scalar
+#define jarr_simd_target_sse2 __attribute__((target("sse2")))
+#define jarr_simd_target_avx2 __attribute__((target("avx2")))
+#define jarr_simd_target_avx512 __attribute__((target("avx512f")))
+
+// the bitwise kernels are written once using the compiler's generic vector
+// types, the target attribute decides which instructions implement them
+
+typedef unsigned long long jarr_simd_vec_sse2 __attribute__((vector_size(16)));
+typedef unsigned long long jarr_simd_vec_avx2 __attribute__((vector_size(32)));
+typedef unsigned long long jarr_simd_vec_avx512
+        __attribute__((vector_size(64)));
+
+// the vector population count instructions need a newer compiler than the
+// rest of the avx-512 kernels
+
+#if (defined(__clang__) && (__clang_major__ >= 6)) \
+    || (!defined(__clang__) && (__GNUC__ >= 8))
+#define jarr_simd_vpopcntq 1
+#else
+#define jarr_simd_vpopcntq 0
+#endif
+#else
+#define jarr_simd_target_scalar
+#endif
+
+typedef jarr_element_t jarr_simd_vec_scalar;
+
+// elements per vector
+
+#define jarr_simd_lanes(isa) (sizeof (jarr_simd_vec_##isa) \
+        / sizeof (jarr_element_t))
+
+#define jarr_simd_op_and(a, b) ((a) & (b))
+#define jarr_simd_op_or(a, b) ((a) | (b))
+#define jarr_simd_op_xor(a, b) ((a) ^ (b))
+#define jarr_simd_op_not(a) (~(a))
+#define jarr_simd_op_andnot(a, b) ((a) & ~(b))
+
+// selects x where s is set and y where it is clear
+
+#define jarr_simd_mux(s, x, y) ((y) ^ (((x) ^ (y)) & (s)))
+
+// evaluates a 3 input truth table with a tree of multiplexers, t[k] is all
+// ones where bit k of the table is set
+
+#define jarr_simd_op_ternary(a, b, c, t)                                       \
+    jarr_simd_mux((a),                                                         \
+        jarr_simd_mux((b), jarr_simd_mux((c), (t)[7], (t)[6]),                 \
+                      jarr_simd_mux((c), (t)[5], (t)[4])),                     \
+        jarr_simd_mux((b), jarr_simd_mux((c), (t)[3], (t)[2]),                 \
+                      jarr_simd_mux((c), (t)[1], (t)[0])))
+
+// the number of elements to process one at a time before out is aligned to
+// align bytes, 0 if out can never be aligned by stepping whole elements
+
+static size_t jarr_simd_head(jarr_element_t const* const out,
+                             size_t const align, size_t const n)
+{
+    size_t const offset = (size_t) ((uintptr_t) out & (align - 1));
+    size_t head = (size_t) 0U;
+    if ((offset != (size_t) 0U)
+        && (((align - offset) % sizeof (jarr_element_t)) == (size_t) 0U))
+    {
+        head = (align - offset) / sizeof (jarr_element_t);
+    }
+    return (head < n) ? head : n;
+}
+
+// the loads and stores go through memcpy so that neither the inputs nor the
+// output need to be aligned, the head loop aligns the stores where possible
+
+#define jarr_simd_binary_kernel(op, isa)                                       \
+jarr_simd_target_##isa static void jarr_simd_##op##_##isa(                     \
+        jarr_element_t * const out, jarr_element_t const* const in1,           \
+        jarr_element_t const* const in2, size_t const n)                       \
+{                                                                              \
+    size_t i = jarr_simd_head(out, sizeof (jarr_simd_vec_##isa), n);          \
+    size_t e;                                                                  \
+    for (e = 0; e < i; ++e)                                                    \
+    {                                                                          \
+        out[e] = jarr_simd_op_##op(in1[e], in2[e]);                            \
+    }                                                                          \
+    for (; i + jarr_simd_lanes(isa) <= n; i += jarr_simd_lanes(isa))           \
+    {                                                                          \
+        jarr_simd_vec_##isa a;                                                 \
+        jarr_simd_vec_##isa b;                                                 \
+        memcpy(&a, in1 + i, sizeof (a));                                       \
+        memcpy(&b, in2 + i, sizeof (b));                                       \
+        a = jarr_simd_op_##op(a, b);                                           \
+        memcpy(out + i, &a, sizeof (a));                                       \
+    }                                                                          \
+    for (; i < n; ++i)                                                         \
+    {                                                                          \
+        out[i] = jarr_simd_op_##op(in1[i], in2[i]);                            \
+    }                                                                          \
+}
+
+#define jarr_simd_unary_kernel(op, isa)                                        \
+jarr_simd_target_##isa static void jarr_simd_##op##_##isa(                     \
+        jarr_element_t * const out, jarr_element_t const* const in,            \
+        size_t const n)                                                        \
+{                                                                              \
+    size_t i = jarr_simd_head(out, sizeof (jarr_simd_vec_##isa), n);          \
+    size_t e;                                                                  \
+    for (e = 0; e < i; ++e)                                                    \
+    {                                                                          \
+        out[e] = jarr_simd_op_##op(in[e]);                                     \
+    }                                                                          \
+    for (; i + jarr_simd_lanes(isa) <= n; i += jarr_simd_lanes(isa))           \
+    {                                                                          \
+        jarr_simd_vec_##isa a;                                                 \
+        memcpy(&a, in + i, sizeof (a));                                        \
+        a = jarr_simd_op_##op(a);                                              \
+        memcpy(out + i, &a, sizeof (a));                                       \
+    }                                                                          \
+    for (; i < n; ++i)                                                         \
+    {                                                                          \
+        out[i] = jarr_simd_op_##op(in[i]);                                     \
+    }                                                                          \
+}
+
+#define jarr_simd_ternary_kernel(isa)                                          \
+jarr_simd_target_##isa static void jarr_simd_ternary_##isa(                    \
+        jarr_element_t * const out, jarr_element_t const* const in1,           \
+        jarr_element_t const* const in2, jarr_element_t const* const in3,      \
+        size_t const n, unsigned char const table)                             \
+{                                                                              \
+    jarr_simd_vec_##isa t[8];                                                  \
+    jarr_element_t t_element[8];                                               \
+    unsigned int k;                                                            \
+    for (k = 0; k < 8; ++k)                                                    \
+    {                                                                          \
+        t_element[k] = (((table >> k) & 1U) != 0U) ? (jarr_element_t) - 1      \
+                : (jarr_element_t) 0;                                          \
+        t[k] = (jarr_simd_vec_##isa) {0} + (unsigned long long)                \
+                ((t_element[k] != (jarr_element_t) 0) ? -1 : 0);               \
+    }                                                                          \
+    size_t i = jarr_simd_head(out, sizeof (jarr_simd_vec_##isa), n);          \
+    size_t e;                                                                  \
+    for (e = 0; e < i; ++e)                                                    \
+    {                                                                          \
+        out[e] = jarr_simd_op_ternary(in1[e], in2[e], in3[e], t_element);      \
+    }                                                                          \
+    for (; i + jarr_simd_lanes(isa) <= n; i += jarr_simd_lanes(isa))           \
+    {                                                                          \
+        jarr_simd_vec_##isa a;                                                 \
+        jarr_simd_vec_##isa b;                                                 \
+        jarr_simd_vec_##isa c;                                                 \
+        memcpy(&a, in1 + i, sizeof (a));                                       \
+        memcpy(&b, in2 + i, sizeof (b));                                       \
+        memcpy(&c, in3 + i, sizeof (c));                                       \
+        a = jarr_simd_op_ternary(a, b, c, t);                                  \
+        memcpy(out + i, &a, sizeof (a));                                       \
+    }                                                                          \
+    for (; i < n; ++i)                                                         \
+    {                                                                          \
+        out[i] = jarr_simd_op_ternary(in1[i], in2[i], in3[i], t_element);      \
+    }                                                                          \
+}
+
+#define jarr_simd_bitwise_kernels(isa)                                         \
+jarr_simd_binary_kernel(and, isa)                                              \
+jarr_simd_binary_kernel(or, isa)                                               \
+jarr_simd_binary_kernel(xor, isa)                                              \
+jarr_simd_unary_kernel(not, isa)                                               \
+jarr_simd_binary_kernel(andnot, isa)
+
+jarr_simd_bitwise_kernels(scalar)
+
+static jarr_length_t jarr_simd_popcount_scalar(jarr_element_t const* const in,
+                                               size_t const n)
+{
+    jarr_length_t count = (jarr_length_t) 0U;
+    size_t i;
+    for (i = 0; i < n; ++i)
+    {
+        count += jarr_popcount_element(in[i]);
+    }
+    return count;
+}
+
+static void jarr_simd_ternary_scalar(jarr_element_t * const out,
+                                     jarr_element_t const* const in1,
+                                     jarr_element_t const* const in2,
+                                     jarr_element_t const* const in3,
+                                     size_t const n, unsigned char const table)
+{
+    jarr_element_t t[8];
+    unsigned int k;
+    for (k = 0; k < 8; ++k)
+    {
+        t[k] = (((table >> k) & 1U) != 0U) ? (jarr_element_t) - 1
+                : (jarr_element_t) 0;
+    }
+    size_t i;
+    for (i = 0; i < n; ++i)
+    {
+        out[i] = jarr_simd_op_ternary(in1[i], in2[i], in3[i], t);
+    }
+}
+
+static size_t jarr_simd_find_scalar(jarr_element_t const* const in,
+                                    size_t const n, jarr_element_t const skip)
+{
+    size_t i = 0;
+    while ((i < n) && (in[i] == skip))
+    {
+        ++i;
+    }
+    return i;
+}
+
+static size_t jarr_simd_rfind_scalar(jarr_element_t const* const in,
+                                     size_t const n, jarr_element_t const skip)
+{
+    size_t i = n;
+    while (i > (size_t) 0U)
+    {
+        --i;
+        if (in[i] != skip)
+        {
+            return i;
+        }
+    }
+    return n;
+}
+
+static size_t jarr_simd_mismatch_scalar(jarr_element_t const* const in1,
+                                        jarr_element_t const* const in2,
+                                        size_t const n)
+{
+    size_t i = 0;
+    while ((i < n) && (in1[i] == in2[i]))
+    {
+        ++i;
+    }
+    return i;
+}
+
+static size_t jarr_simd_rmismatch_scalar(jarr_element_t const* const in1,
+                                         jarr_element_t const* const in2,
+                                         size_t const n)
+{
+    size_t i = n;
+    while (i > (size_t) 0U)
+    {
+        --i;
+        if (in1[i] != in2[i])
+        {
+            return i;
+        }
+    }
+    return n;
+}
+
+static void jarr_simd_funnel_scalar(unsigned char * const out,
+                                    unsigned char const* const in,
+                                    size_t const n, unsigned int const shift)
+{
+    size_t i;
+    for (i = 0; i < n; ++i)
+    {
+        uint64_t const w = jarr_simd_funnel_word(in + (i * 8U), shift);
+        memcpy(out + (i * 8U), &w, sizeof (w));
+    }
+}
+
+static void jarr_simd_funnel_down_scalar(unsigned char * const out,
+                                         unsigned char const* const in,
+                                         size_t const n,
+                                         unsigned int const shift)
+{
+    size_t i = n;
+    while (i > (size_t) 0U)
+    {
+        --i;
+        uint64_t const w = jarr_simd_funnel_word(in + (i * 8U), shift);
+        memcpy(out + (i * 8U), &w, sizeof (w));
+    }
+}
+
+static struct jarr_simd_kernels const jarr_simd_kernels_scalar = {
+    jarr_simd_and_scalar,
+    jarr_simd_or_scalar,
+    jarr_simd_xor_scalar,
+    jarr_simd_not_scalar,
+    jarr_simd_popcount_scalar,
+    jarr_simd_find_scalar,
+    jarr_simd_rfind_scalar,
+    jarr_simd_andnot_scalar,
+    jarr_simd_ternary_scalar,
+    jarr_simd_funnel_scalar,
+    jarr_simd_funnel_down_scalar,
+    jarr_simd_mismatch_scalar,
+    jarr_simd_rmismatch_scalar,
+};
+
+#if jarr_simd_x86 != 0
+
+// population count of each 64 bit lane of a vector
+
+#define jarr_simd_lane_popcount(isa)                                           \
+jarr_simd_target_##isa static inline jarr_simd_vec_##isa                       \
+jarr_simd_lane_popcount_##isa(jarr_simd_vec_##isa x)                           \
+{                                                                              \
+    x = x - ((x >> 1) & 0x5555555555555555ULL);                                \
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);      \
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;                                \
+    x = x + (x >> 8);                                                          \
+    x = x + (x >> 16);                                                         \
+    x = x + (x >> 32);                                                         \
+    return x & 0x7fULL;                                                        \
+}
+
+// carry save adder, adds 3 bits in every position into a high and low bit
+
+#define jarr_simd_csa(h, l, a, b, c)                                           \
+    do                                                                         \
+    {                                                                          \
+        u = (a) ^ (b);                                                         \
+        (h) = ((a) & (b)) | (u & (c));                                         \
+        (l) = u ^ (c);                                                         \
+    }                                                                          \
+    while (0)
+
+// Harley-Seal population count, 16 vectors are reduced through a tree of carry
+// save adders so that a full population count is only needed once per 16
+// vectors
+
+#define jarr_simd_popcount_kernel(isa)                                         \
+jarr_simd_lane_popcount(isa)                                                   \
+jarr_simd_target_##isa static jarr_length_t jarr_simd_popcount_##isa(          \
+        jarr_element_t const* const in, size_t const n)                        \
+{                                                                              \
+    size_t const lanes = jarr_simd_lanes(isa);                                 \
+    jarr_simd_vec_##isa v[16];                                                 \
+    jarr_simd_vec_##isa total = {0};                                           \
+    jarr_simd_vec_##isa ones = {0};                                            \
+    jarr_simd_vec_##isa twos = {0};                                            \
+    jarr_simd_vec_##isa fours = {0};                                           \
+    jarr_simd_vec_##isa eights = {0};                                          \
+    jarr_simd_vec_##isa sixteens;                                              \
+    jarr_simd_vec_##isa twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;  \
+    jarr_simd_vec_##isa u;                                                     \
+    size_t i = 0;                                                              \
+    for (; i + (16 * lanes) <= n; i += 16 * lanes)                             \
+    {                                                                          \
+        memcpy(v, in + i, sizeof (v));                                         \
+        jarr_simd_csa(twos_a, ones, ones, v[0], v[1]);                         \
+        jarr_simd_csa(twos_b, ones, ones, v[2], v[3]);                         \
+        jarr_simd_csa(fours_a, twos, twos, twos_a, twos_b);                    \
+        jarr_simd_csa(twos_a, ones, ones, v[4], v[5]);                         \
+        jarr_simd_csa(twos_b, ones, ones, v[6], v[7]);                         \
+        jarr_simd_csa(fours_b, twos, twos, twos_a, twos_b);                    \
+        jarr_simd_csa(eights_a, fours, fours, fours_a, fours_b);               \
+        jarr_simd_csa(twos_a, ones, ones, v[8], v[9]);                         \
+        jarr_simd_csa(twos_b, ones, ones, v[10], v[11]);                       \
+        jarr_simd_csa(fours_a, twos, twos, twos_a, twos_b);                    \
+        jarr_simd_csa(twos_a, ones, ones, v[12], v[13]);                       \
+        jarr_simd_csa(twos_b, ones, ones, v[14], v[15]);                       \
+        jarr_simd_csa(fours_b, twos, twos, twos_a, twos_b);                    \
+        jarr_simd_csa(eights_b, fours, fours, fours_a, fours_b);               \
+        jarr_simd_csa(sixteens, eights, eights, eights_a, eights_b);           \
+        total += jarr_simd_lane_popcount_##isa(sixteens);                      \
+    }                                                                          \
+    total = (total << 4)                                                       \
+            + (jarr_simd_lane_popcount_##isa(eights) << 3)                     \
+            + (jarr_simd_lane_popcount_##isa(fours) << 2)                      \
+            + (jarr_simd_lane_popcount_##isa(twos) << 1)                       \
+            + jarr_simd_lane_popcount_##isa(ones);                             \
+    for (; i + lanes <= n; i += lanes)                                         \
+    {                                                                          \
+        memcpy(&u, in + i, sizeof (u));                                        \
+        total += jarr_simd_lane_popcount_##isa(u);                             \
+    }                                                                          \
+    jarr_length_t count = (jarr_length_t) 0U;                                  \
+    size_t l;                                                                  \
+    for (l = 0; l < sizeof (total) / sizeof (total[0]); ++l)                   \
+    {                                                                          \
+        count += (jarr_length_t) total[l];                                     \
+    }                                                                          \
+    for (; i < n; ++i)                                                         \
+    {                                                                          \
+        count += jarr_popcount_element(in[i]);                                 \
+    }                                                                          \
+    return count;                                                              \
+}
+
+// non zero if any bit of a vector is set
+
+jarr_simd_target_sse2 static inline int jarr_simd_any_sse2(
+        jarr_simd_vec_sse2 const v)
+{
+    __m128i const x = (__m128i) v;
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_setzero_si128()))
+            != 0xffff;
+}
+
+jarr_simd_target_avx2 static inline int jarr_simd_any_avx2(
+        jarr_simd_vec_avx2 const v)
+{
+    __m256i const x = (__m256i) v;
+    return !_mm256_testz_si256(x, x);
+}
+
+jarr_simd_target_avx512 static inline int jarr_simd_any_avx512(
+        jarr_simd_vec_avx512 const v)
+{
+    __m512i const x = (__m512i) v;
+    return _mm512_test_epi64_mask(x, x) != 0;
+}
+
+// skipping runs of elements equal to skip, 4 vectors at a time, then 1 vector
+// at a time and then 1 element at a time to find the exact element
+
+#define jarr_simd_find_kernel(isa)                                             \
+jarr_simd_target_##isa static size_t jarr_simd_find_##isa(                     \
+        jarr_element_t const* const in, size_t const n,                        \
+        jarr_element_t const skip)                                             \
+{                                                                              \
+    size_t const lanes = jarr_simd_lanes(isa);                                 \
+    jarr_simd_vec_##isa const skip_v = (jarr_simd_vec_##isa) {0}               \
+            + (unsigned long long) ((skip != (jarr_element_t) 0) ? -1 : 0);    \
+    jarr_simd_vec_##isa v[4];                                                  \
+    size_t i = 0;                                                              \
+    for (; i + (4 * lanes) <= n; i += 4 * lanes)                               \
+    {                                                                          \
+        memcpy(v, in + i, sizeof (v));                                         \
+        if (jarr_simd_any_##isa((v[0] ^ skip_v) | (v[1] ^ skip_v)              \
+                                | (v[2] ^ skip_v) | (v[3] ^ skip_v)))          \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+    }                                                                          \
+    for (; i + lanes <= n; i += lanes)                                         \
+    {                                                                          \
+        memcpy(v, in + i, sizeof (v[0]));                                      \
+        if (jarr_simd_any_##isa(v[0] ^ skip_v))                                \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+    }                                                                          \
+    while ((i < n) && (in[i] == skip))                                         \
+    {                                                                          \
+        ++i;                                                                   \
+    }                                                                          \
+    return i;                                                                  \
+}                                                                              \
+                                                                               \
+jarr_simd_target_##isa static size_t jarr_simd_rfind_##isa(                    \
+        jarr_element_t const* const in, size_t const n,                        \
+        jarr_element_t const skip)                                             \
+{                                                                              \
+    size_t const lanes = jarr_simd_lanes(isa);                                 \
+    jarr_simd_vec_##isa const skip_v = (jarr_simd_vec_##isa) {0}               \
+            + (unsigned long long) ((skip != (jarr_element_t) 0) ? -1 : 0);    \
+    jarr_simd_vec_##isa v[4];                                                  \
+    size_t i = n;                                                              \
+    for (; i >= 4 * lanes; i -= 4 * lanes)                                     \
+    {                                                                          \
+        memcpy(v, in + i - (4 * lanes), sizeof (v));                           \
+        if (jarr_simd_any_##isa((v[0] ^ skip_v) | (v[1] ^ skip_v)              \
+                                | (v[2] ^ skip_v) | (v[3] ^ skip_v)))          \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+    }                                                                          \
+    for (; i >= lanes; i -= lanes)                                             \
+    {                                                                          \
+        memcpy(v, in + i - lanes, sizeof (v[0]));                              \
+        if (jarr_simd_any_##isa(v[0] ^ skip_v))                                \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+    }                                                                          \
+    while (i > (size_t) 0U)                                                    \
+    {                                                                          \
+        --i;                                                                   \
+        if (in[i] != skip)                                                     \
+        {                                                                      \
+            return i;                                                          \
+        }                                                                      \
+    }                                                                          \
+    return n;                                                                  \
+}
+
+// the same as find but for elements that differ between two arrays, so a
+// comparison stops at the first difference rather than xoring everything
+// first
+
+#define jarr_simd_mismatch_kernel(isa)                                         \
+jarr_simd_target_##isa static size_t jarr_simd_mismatch_##isa(                 \
+        jarr_element_t const* const in1, jarr_element_t const* const in2,      \
+        size_t const n)                                                        \
+{                                                                              \
+    size_t const lanes = jarr_simd_lanes(isa);                                 \
+    jarr_simd_vec_##isa a[4];                                                  \
+    jarr_simd_vec_##isa b[4];                                                  \
+    size_t i = 0;                                                              \
+    for (; i + (4 * lanes) <= n; i += 4 * lanes)                               \
+    {                                                                          \
+        memcpy(a, in1 + i, sizeof (a));                                        \
+        memcpy(b, in2 + i, sizeof (b));                                        \
+        if (jarr_simd_any_##isa((a[0] ^ b[0]) | (a[1] ^ b[1])                  \
+                                | (a[2] ^ b[2]) | (a[3] ^ b[3])))              \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+    }                                                                          \
+    for (; i + lanes <= n; i += lanes)                                         \
+    {                                                                          \
+        memcpy(a, in1 + i, sizeof (a[0]));                                     \
+        memcpy(b, in2 + i, sizeof (b[0]));                                     \
+        if (jarr_simd_any_##isa(a[0] ^ b[0]))                                  \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+    }                                                                          \
+    while ((i < n) && (in1[i] == in2[i]))                                      \
+    {                                                                          \
+        ++i;                                                                   \
+    }                                                                          \
+    return i;                                                                  \
+}                                                                              \
+                                                                               \
+jarr_simd_target_##isa static size_t jarr_simd_rmismatch_##isa(                \
+        jarr_element_t const* const in1, jarr_element_t const* const in2,      \
+        size_t const n)                                                        \
+{                                                                              \
+    size_t const lanes = jarr_simd_lanes(isa);                                 \
+    jarr_simd_vec_##isa a[4];                                                  \
+    jarr_simd_vec_##isa b[4];                                                  \
+    size_t i = n;                                                              \
+    for (; i >= 4 * lanes; i -= 4 * lanes)                                     \
+    {                                                                          \
+        memcpy(a, in1 + i - (4 * lanes), sizeof (a));                          \
+        memcpy(b, in2 + i - (4 * lanes), sizeof (b));                          \
+        if (jarr_simd_any_##isa((a[0] ^ b[0]) | (a[1] ^ b[1])                  \
+                                | (a[2] ^ b[2]) | (a[3] ^ b[3])))              \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+    }                                                                          \
+    for (; i >= lanes; i -= lanes)                                             \
+    {                                                                          \
+        memcpy(a, in1 + i - lanes, sizeof (a[0]));                             \
+        memcpy(b, in2 + i - lanes, sizeof (b[0]));                             \
+        if (jarr_simd_any_##isa(a[0] ^ b[0]))                                  \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+    }                                                                          \
+    while (i > (size_t) 0U)                                                    \
+    {                                                                          \
+        --i;                                                                   \
+        if (in1[i] != in2[i])                                                  \
+        {                                                                      \
+            return i;                                                          \
+        }                                                                      \
+    }                                                                          \
+    return n;                                                                  \
+}
+
+// each vector is loaded again a byte on to supply its top bits, which is
+// cheaper than shuffling the next word into place. All the loads of a vector
+// come before its store, so working in place only needs the right direction
+
+#define jarr_simd_funnel_vector(isa, i)                                        \
+    do                                                                         \
+    {                                                                          \
+        jarr_simd_vec_##isa lo;                                                \
+        jarr_simd_vec_##isa hi;                                                \
+        memcpy(&lo, in + ((i) * 8U), sizeof (lo));                             \
+        memcpy(&hi, in + ((i) * 8U) + 1U, sizeof (hi));                        \
+        lo = (lo >> shift) | (hi << (8U - shift));                             \
+        memcpy(out + ((i) * 8U), &lo, sizeof (lo));                            \
+    }                                                                          \
+    while (0)
+
+#define jarr_simd_funnel_kernel(isa)                                           \
+jarr_simd_target_##isa static void jarr_simd_funnel_##isa(                     \
+        unsigned char * const out, unsigned char const* const in,              \
+        size_t const n, unsigned int const shift)                              \
+{                                                                              \
+    size_t const lanes = sizeof (jarr_simd_vec_##isa) / 8U;                    \
+    size_t i = 0;                                                              \
+    for (; i + lanes <= n; i += lanes)                                         \
+    {                                                                          \
+        jarr_simd_funnel_vector(isa, i);                                       \
+    }                                                                          \
+    for (; i < n; ++i)                                                         \
+    {                                                                          \
+        uint64_t const w = jarr_simd_funnel_word(in + (i * 8U), shift);        \
+        memcpy(out + (i * 8U), &w, sizeof (w));                                \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+jarr_simd_target_##isa static void jarr_simd_funnel_down_##isa(                \
+        unsigned char * const out, unsigned char const* const in,              \
+        size_t const n, unsigned int const shift)                              \
+{                                                                              \
+    size_t const lanes = sizeof (jarr_simd_vec_##isa) / 8U;                    \
+    size_t i = n;                                                              \
+    while (i >= lanes)                                                         \
+    {                                                                          \
+        i -= lanes;                                                            \
+        jarr_simd_funnel_vector(isa, i);                                       \
+    }                                                                          \
+    while (i > (size_t) 0U)                                                    \
+    {                                                                          \
+        --i;                                                                   \
+        uint64_t const w = jarr_simd_funnel_word(in + (i * 8U), shift);        \
+        memcpy(out + (i * 8U), &w, sizeof (w));                                \
+    }                                                                          \
+}
+
+jarr_simd_bitwise_kernels(sse2)
+jarr_simd_bitwise_kernels(avx2)
+jarr_simd_bitwise_kernels(avx512)
+
+jarr_simd_popcount_kernel(sse2)
+jarr_simd_popcount_kernel(avx2)
+jarr_simd_popcount_kernel(avx512)
+
+jarr_simd_find_kernel(sse2)
+jarr_simd_find_kernel(avx2)
+jarr_simd_find_kernel(avx512)
+
+jarr_simd_mismatch_kernel(sse2)
+jarr_simd_mismatch_kernel(avx2)
+jarr_simd_mismatch_kernel(avx512)
+
+jarr_simd_ternary_kernel(sse2)
+jarr_simd_ternary_kernel(avx2)
+
+jarr_simd_funnel_kernel(sse2)
+jarr_simd_funnel_kernel(avx2)
+jarr_simd_funnel_kernel(avx512)
+
+// the ternary logic instruction takes its truth table as an immediate, so
+// there is a copy of the loop for every table
+
+#define jarr_simd_ternlog_case(table)                                          \
+    case (table):                                                              \
+        for (; i + lanes <= n; i += lanes)                                     \
+        {                                                                      \
+            _mm512_storeu_si512((void*) (out + i), _mm512_ternarylogic_epi64(  \
+                _mm512_loadu_si512((void const*) (in1 + i)),                   \
+                _mm512_loadu_si512((void const*) (in2 + i)),                   \
+                _mm512_loadu_si512((void const*) (in3 + i)), (table)));        \
+        }                                                                      \
+        break;
+
+#define jarr_simd_ternlog_cases16(base)                                        \
+    jarr_simd_ternlog_case((base) + 0) jarr_simd_ternlog_case((base) + 1)      \
+    jarr_simd_ternlog_case((base) + 2) jarr_simd_ternlog_case((base) + 3)      \
+    jarr_simd_ternlog_case((base) + 4) jarr_simd_ternlog_case((base) + 5)      \
+    jarr_simd_ternlog_case((base) + 6) jarr_simd_ternlog_case((base) + 7)      \
+    jarr_simd_ternlog_case((base) + 8) jarr_simd_ternlog_case((base) + 9)      \
+    jarr_simd_ternlog_case((base) + 10) jarr_simd_ternlog_case((base) + 11)    \
+    jarr_simd_ternlog_case((base) + 12) jarr_simd_ternlog_case((base) + 13)    \
+    jarr_simd_ternlog_case((base) + 14) jarr_simd_ternlog_case((base) + 15)
+
+jarr_simd_target_avx512 static void jarr_simd_ternary_avx512(
+        jarr_element_t * const out, jarr_element_t const* const in1,
+        jarr_element_t const* const in2, jarr_element_t const* const in3,
+        size_t const n, unsigned char const table)
+{
+    size_t const lanes = jarr_simd_lanes(avx512);
+    size_t i = 0;
+    switch (table)
+    {
+        jarr_simd_ternlog_cases16(0)
+        jarr_simd_ternlog_cases16(16)
+        jarr_simd_ternlog_cases16(32)
+        jarr_simd_ternlog_cases16(48)
+        jarr_simd_ternlog_cases16(64)
+        jarr_simd_ternlog_cases16(80)
+        jarr_simd_ternlog_cases16(96)
+        jarr_simd_ternlog_cases16(112)
+        jarr_simd_ternlog_cases16(128)
+        jarr_simd_ternlog_cases16(144)
+        jarr_simd_ternlog_cases16(160)
+        jarr_simd_ternlog_cases16(176)
+        jarr_simd_ternlog_cases16(192)
+        jarr_simd_ternlog_cases16(208)
+        jarr_simd_ternlog_cases16(224)
+        jarr_simd_ternlog_cases16(240)
+    }
+    jarr_simd_ternary_scalar(out + i, in1 + i, in2 + i, in3 + i, n - i, table);
+}
+
+#if jarr_simd_vpopcntq != 0
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static jarr_length_t jarr_simd_popcount_vpopcntq(
+        jarr_element_t const* const in, size_t const n)
+{
+    size_t const lanes = 64 / sizeof (jarr_element_t);
+    __m512i total = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(
+                _mm512_loadu_si512((void const*) (in + i))));
+    }
+    jarr_length_t count = (jarr_length_t) _mm512_reduce_add_epi64(total);
+    for (; i < n; ++i)
+    {
+        count += jarr_popcount_element(in[i]);
+    }
+    return count;
+}
+
+#endif
+
+static struct jarr_simd_kernels const jarr_simd_kernels_sse2 = {
+    jarr_simd_and_sse2,
+    jarr_simd_or_sse2,
+    jarr_simd_xor_sse2,
+    jarr_simd_not_sse2,
+    jarr_simd_popcount_sse2,
+    jarr_simd_find_sse2,
+    jarr_simd_rfind_sse2,
+    jarr_simd_andnot_sse2,
+    jarr_simd_ternary_sse2,
+    jarr_simd_funnel_sse2,
+    jarr_simd_funnel_down_sse2,
+    jarr_simd_mismatch_sse2,
+    jarr_simd_rmismatch_sse2,
+};
+
+static struct jarr_simd_kernels const jarr_simd_kernels_avx2 = {
+    jarr_simd_and_avx2,
+    jarr_simd_or_avx2,
+    jarr_simd_xor_avx2,
+    jarr_simd_not_avx2,
+    jarr_simd_popcount_avx2,
+    jarr_simd_find_avx2,
+    jarr_simd_rfind_avx2,
+    jarr_simd_andnot_avx2,
+    jarr_simd_ternary_avx2,
+    jarr_simd_funnel_avx2,
+    jarr_simd_funnel_down_avx2,
+    jarr_simd_mismatch_avx2,
+    jarr_simd_rmismatch_avx2,
+};
+
+static struct jarr_simd_kernels const jarr_simd_kernels_avx512 = {
+    jarr_simd_and_avx512,
+    jarr_simd_or_avx512,
+    jarr_simd_xor_avx512,
+    jarr_simd_not_avx512,
+    jarr_simd_popcount_avx512,
+    jarr_simd_find_avx512,
+    jarr_simd_rfind_avx512,
+    jarr_simd_andnot_avx512,
+    jarr_simd_ternary_avx512,
+    jarr_simd_funnel_avx512,
+    jarr_simd_funnel_down_avx512,
+    jarr_simd_mismatch_avx512,
+    jarr_simd_rmismatch_avx512,
+};
+
+#if jarr_simd_vpopcntq != 0
+
+static struct jarr_simd_kernels const jarr_simd_kernels_avx512_vpopcntq = {
+    jarr_simd_and_avx512,
+    jarr_simd_or_avx512,
+    jarr_simd_xor_avx512,
+    jarr_simd_not_avx512,
+    jarr_simd_popcount_vpopcntq,
+    jarr_simd_find_avx512,
+    jarr_simd_rfind_avx512,
+    jarr_simd_andnot_avx512,
+    jarr_simd_ternary_avx512,
+    jarr_simd_funnel_avx512,
+    jarr_simd_funnel_down_avx512,
+    jarr_simd_mismatch_avx512,
+    jarr_simd_rmismatch_avx512,
+};
+
+#endif
+
+// the best instruction set the cpu (and os) supports, found with cpuid
+
+static enum jarr_isa jarr_simd_detect(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        return jarr_isa_avx512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return jarr_isa_avx2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return jarr_isa_sse2;
+    }
+    return jarr_isa_scalar;
+}
+
+#else
+
+static enum jarr_isa jarr_simd_detect(void)
+{
+    return jarr_isa_scalar;
+}
+
+#endif
+
+static struct jarr_simd_kernels const* jarr_simd_table(enum jarr_isa const isa)
+{
+    switch (isa)
+    {
+#if jarr_simd_x86 != 0
+    case jarr_isa_avx512:
+#if jarr_simd_vpopcntq != 0
+        if (__builtin_cpu_supports("avx512vpopcntdq"))
+        {
+            return &jarr_simd_kernels_avx512_vpopcntq;
+        }
+#endif
+        return &jarr_simd_kernels_avx512;
+    case jarr_isa_avx2:
+        return &jarr_simd_kernels_avx2;
+    case jarr_isa_sse2:
+        return &jarr_simd_kernels_sse2;
+#endif
+    default:
+        return &jarr_simd_kernels_scalar;
+    }
+}
+
+// jarr_isa_count means not yet detected, every thread that races to detect it
+// stores the same value
+
+static int jarr_simd_isa = (int) jarr_isa_count;
+
+#if jarr_simd_x86 != 0
+#define jarr_simd_load_isa() __atomic_load_n(&jarr_simd_isa, __ATOMIC_RELAXED)
+#define jarr_simd_store_isa(isa) \
+        __atomic_store_n(&jarr_simd_isa, (int) (isa), __ATOMIC_RELAXED)
+#else
+#define jarr_simd_load_isa() (jarr_simd_isa)
+#define jarr_simd_store_isa(isa) (jarr_simd_isa = (int) (isa))
+#endif
+
+enum jarr_isa jarr_get_isa(void)
+{
+    int isa = jarr_simd_load_isa();
+    if (isa == (int) jarr_isa_count)
+    {
+        isa = (int) jarr_simd_detect();
+        jarr_simd_store_isa(isa);
+    }
+    return (enum jarr_isa) isa;
+}
+
+enum jarr_isa jarr_set_isa(enum jarr_isa isa)
+{
+    enum jarr_isa const supported = jarr_simd_detect();
+    if ((int) isa > (int) supported)
+    {
+        isa = supported;
+    }
+    jarr_simd_store_isa(isa);
+    return isa;
+}
+
+struct jarr_simd_kernels const* jarr_simd_get_kernels(void)
+{
+    return jarr_simd_table(jarr_get_isa());
+}
@@ -0,0 +1,98 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+// internal interface to the instruction set specific kernels, not part of the
+// public api
+
+#ifndef JARR_SIMD_H
+#define	JARR_SIMD_H
+
+#include "jarr.h"
+
+#include <string.h>
+
+// every kernel works on n whole elements, an output may be the same array as
+// any of the inputs but must not partially overlap it
+
+struct jarr_simd_kernels
+{
+    void (*bw_and)(jarr_element_t * const out, jarr_element_t const* const in1,
+                   jarr_element_t const* const in2, size_t const n);
+    void (*bw_or)(jarr_element_t * const out, jarr_element_t const* const in1,
+                  jarr_element_t const* const in2, size_t const n);
+    void (*bw_xor)(jarr_element_t * const out, jarr_element_t const* const in1,
+                   jarr_element_t const* const in2, size_t const n);
+    void (*bw_not)(jarr_element_t * const out, jarr_element_t const* const in,
+                   size_t const n);
+    jarr_length_t (*popcount)(jarr_element_t const* const in, size_t const n);
+    // the index of the first/last element not equal to skip, or n if there is
+    // none, skip must be 0 or all ones
+    size_t (*find)(jarr_element_t const* const in, size_t const n,
+                   jarr_element_t const skip);
+    size_t (*rfind)(jarr_element_t const* const in, size_t const n,
+                    jarr_element_t const skip);
+    void (*bw_andnot)(jarr_element_t * const out,
+                      jarr_element_t const* const in1,
+                      jarr_element_t const* const in2, size_t const n);
+    // bit (in1 << 2) | (in2 << 1) | in3 of table is the output for those
+    // input bits, as with the avx-512 ternary logic instruction
+    void (*bw_ternary)(jarr_element_t * const out,
+                       jarr_element_t const* const in1,
+                       jarr_element_t const* const in2,
+                       jarr_element_t const* const in3, size_t const n,
+                       unsigned char const table);
+    // out word i is the 64 bits starting shift bits into byte 8i of in, a word
+    // being 8 bytes loaded little endian. Works on n words of out, reading
+    // 8n + 1 bytes of in, 0 < shift < 8. funnel goes up through the words, so
+    // out may be the same as in or below it, funnel_down goes down through
+    // them, so out may be above in
+    void (*funnel)(unsigned char * const out, unsigned char const* const in,
+                   size_t const n, unsigned int const shift);
+    void (*funnel_down)(unsigned char * const out,
+                        unsigned char const* const in, size_t const n,
+                        unsigned int const shift);
+    // the index of the first/last element where in1 and in2 differ, or n if
+    // they are the same
+    size_t (*mismatch)(jarr_element_t const* const in1,
+                       jarr_element_t const* const in2, size_t const n);
+    size_t (*rmismatch)(jarr_element_t const* const in1,
+                        jarr_element_t const* const in2, size_t const n);
+};
+
+struct jarr_simd_kernels const* jarr_simd_get_kernels(void);
+
+// the 64 bits starting shift bits into in, 0 < shift < 8. The word loaded a
+// byte on supplies the top bits, so exactly 9 bytes are read
+
+inline static uint64_t jarr_simd_funnel_word(unsigned char const* const in,
+                                             unsigned int const shift)
+{
+    uint64_t lo;
+    uint64_t hi;
+    memcpy(&lo, in, sizeof (lo));
+    memcpy(&hi, in + 1, sizeof (hi));
+    return (lo >> shift) | (hi << (8U - shift));
+}
+
+#endif
@@ -0,0 +1,312 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#include "jarr_stream.h"
+
+enum jarr_stream_op
+{
+    jarr_stream_op_and,
+    jarr_stream_op_or,
+    jarr_stream_op_xor,
+    jarr_stream_op_andnot,
+    jarr_stream_op_not,
+    jarr_stream_op_add
+};
+
+// the number of elements in a 64 bit word, windows start on word boundaries
+// so the checksum can be kept as they are written
+
+#define jarr_stream_word_elements (64U / jarr_element_bits)
+
+// the number of elements in each window when the buffer is split between
+// windows windows, each with spare elements past its end. 0 if the buffer is
+// too small
+
+static size_t jarr_stream_window_length(size_t const length_buffer,
+                                        size_t const windows,
+                                        size_t const spare)
+{
+    size_t const length = length_buffer / windows;
+    if (length <= spare)
+    {
+        return 0;
+    }
+    return ((length - spare) / jarr_stream_word_elements)
+            * jarr_stream_word_elements;
+}
+
+// out = in1 op in2 a window at a time, the result is built in in1's window
+
+static enum jarr_file_status jarr_stream_op(struct jarr_stream * const out,
+                                            struct jarr_stream const* const in1,
+                                            struct jarr_stream const* const in2,
+                                            unsigned char * const carry,
+                                            enum jarr_stream_op const op,
+                                            jarr_element_t * const buffer,
+                                            size_t const length_buffer)
+{
+    size_t const windows = (in2 != NULL) ? 2U : 1U;
+    size_t const length_window = jarr_stream_window_length(length_buffer,
+                                                           windows, 0);
+    if ((out->length_bits != in1->length_bits) || ((in2 != NULL)
+        && (in2->length_bits != in1->length_bits)))
+    {
+        return jarr_file_error_length;
+    }
+    if (length_window == (size_t) 0U)
+    {
+        return jarr_file_error_buffer;
+    }
+    jarr_length_t const window_bits = (jarr_length_t) length_window
+            * jarr_element_length;
+
+    jarr_length_t start;
+    for (start = 0; start < out->length_bits; start += window_bits)
+    {
+        jarr_length_t const bits = (out->length_bits - start < window_bits)
+                ? out->length_bits - start : window_bits;
+        struct jarr a = jarr_init(buffer, bits);
+        struct jarr b = jarr_init(buffer + length_window, bits);
+        enum jarr_file_status status = jarr_stream_read(in1, &a, start);
+        if ((status == jarr_file_ok) && (in2 != NULL))
+        {
+            status = jarr_stream_read(in2, &b, start);
+        }
+        if (status != jarr_file_ok)
+        {
+            return status;
+        }
+        switch (op)
+        {
+        case jarr_stream_op_and:
+            jarr_bw_and(&a, &a, &b);
+            break;
+        case jarr_stream_op_or:
+            jarr_bw_or(&a, &a, &b);
+            break;
+        case jarr_stream_op_xor:
+            jarr_bw_xor(&a, &a, &b);
+            break;
+        case jarr_stream_op_andnot:
+            jarr_bw_andnot(&a, &a, &b);
+            break;
+        case jarr_stream_op_not:
+            jarr_bw_not(&a, &a);
+            break;
+        case jarr_stream_op_add:
+            // every window but the last is a whole number of elements, so the
+            // carry out of one is the carry into the next
+            *carry = jarr_add(&a, &a, &b, *carry);
+            break;
+        }
+        status = jarr_stream_write(out, &a, start);
+        if (status != jarr_file_ok)
+        {
+            return status;
+        }
+    }
+    return jarr_file_ok;
+}
+
+// reads the bits of in from low to high into window from bit offset, the rest
+// of window is cleared. tmp must hold 2 more elements than window
+
+static enum jarr_file_status jarr_stream_read_section(struct jarr_stream
+                                                      const* const in,
+                                                      struct jarr * const
+                                                      window,
+                                                      jarr_length_t const
+                                                      offset,
+                                                      jarr_length_t const low,
+                                                      jarr_length_t const high,
+                                                      jarr_element_t * const
+                                                      tmp)
+{
+    jarr_clear_all(window);
+    if (low >= high)
+    {
+        return jarr_file_ok;
+    }
+    // the elements holding the bits, shifted down to start at low
+    jarr_length_t const first = low - (low % jarr_element_length);
+    struct jarr section = jarr_init(tmp, high - first);
+    enum jarr_file_status const status = jarr_stream_read(in, &section, first);
+    if (status != jarr_file_ok)
+    {
+        return status;
+    }
+    if (low != first)
+    {
+        jarr_rshift(&section, &section, low - first);
+    }
+    jarr_set_length(&section, high - low);
+    jarr_write_section(window, &section, offset);
+    return jarr_file_ok;
+}
+
+// out = in shifted left, or right if right is set. Each output window is read
+// from the section of the input it comes from, so the bits that spill over a
+// window boundary land in the right window without being held back
+
+static enum jarr_file_status jarr_stream_shift(struct jarr_stream * const out,
+                                               struct jarr_stream const* const
+                                               in, jarr_length_t const shift,
+                                               unsigned char const right,
+                                               jarr_element_t * const buffer,
+                                               size_t const length_buffer)
+{
+    size_t const length_window = jarr_stream_window_length(length_buffer, 2U,
+                                                           2U);
+    if (out->length_bits != in->length_bits)
+    {
+        return jarr_file_error_length;
+    }
+    if (length_window == (size_t) 0U)
+    {
+        return jarr_file_error_buffer;
+    }
+    jarr_length_t const window_bits = (jarr_length_t) length_window
+            * jarr_element_length;
+    jarr_element_t * const tmp = buffer + length_window;
+    jarr_length_t const length = in->length_bits;
+
+    jarr_length_t start;
+    for (start = 0; start < length; start += window_bits)
+    {
+        jarr_length_t const bits = (length - start < window_bits)
+                ? length - start : window_bits;
+        struct jarr window = jarr_init(buffer, bits);
+        jarr_length_t offset = 0;
+        jarr_length_t low = length;
+        jarr_length_t high = length;
+        if (right != 0)
+        {
+            if (shift < length - start)
+            {
+                low = start + shift;
+                high = (bits < length - low) ? low + bits : length;
+            }
+        }
+        else if (shift < start + bits)
+        {
+            low = (start >= shift) ? start - shift : 0;
+            offset = (start >= shift) ? 0 : shift - start;
+            high = start + bits - shift;
+        }
+        enum jarr_file_status status = jarr_stream_read_section(in, &window,
+                                                                offset, low,
+                                                                high, tmp);
+        if (status == jarr_file_ok)
+        {
+            status = jarr_stream_write(out, &window, start);
+        }
+        if (status != jarr_file_ok)
+        {
+            return status;
+        }
+    }
+    return jarr_file_ok;
+}
+
+enum jarr_file_status jarr_stream_bw_and(struct jarr_stream * const out,
+                                         struct jarr_stream const* const in1,
+                                         struct jarr_stream const* const in2,
+                                         jarr_element_t * const buffer,
+                                         size_t const length_buffer)
+{
+    return jarr_stream_op(out, in1, in2, NULL, jarr_stream_op_and, buffer,
+                          length_buffer);
+}
+
+enum jarr_file_status jarr_stream_bw_or(struct jarr_stream * const out,
+                                        struct jarr_stream const* const in1,
+                                        struct jarr_stream const* const in2,
+                                        jarr_element_t * const buffer,
+                                        size_t const length_buffer)
+{
+    return jarr_stream_op(out, in1, in2, NULL, jarr_stream_op_or, buffer,
+                          length_buffer);
+}
+
+enum jarr_file_status jarr_stream_bw_xor(struct jarr_stream * const out,
+                                         struct jarr_stream const* const in1,
+                                         struct jarr_stream const* const in2,
+                                         jarr_element_t * const buffer,
+                                         size_t const length_buffer)
+{
+    return jarr_stream_op(out, in1, in2, NULL, jarr_stream_op_xor, buffer,
+                          length_buffer);
+}
+
+enum jarr_file_status jarr_stream_bw_andnot(struct jarr_stream * const out,
+                                            struct jarr_stream const* const
+                                            in1,
+                                            struct jarr_stream const* const
+                                            in2,
+                                            jarr_element_t * const buffer,
+                                            size_t const length_buffer)
+{
+    return jarr_stream_op(out, in1, in2, NULL, jarr_stream_op_andnot, buffer,
+                          length_buffer);
+}
+
+enum jarr_file_status jarr_stream_bw_not(struct jarr_stream * const out,
+                                         struct jarr_stream const* const in,
+                                         jarr_element_t * const buffer,
+                                         size_t const length_buffer)
+{
+    return jarr_stream_op(out, in, NULL, NULL, jarr_stream_op_not, buffer,
+                          length_buffer);
+}
+
+// adds 2 streams, carry is the carry in and is set to the carry out
+
+enum jarr_file_status jarr_stream_add(struct jarr_stream * const out,
+                                      struct jarr_stream const* const in1,
+                                      struct jarr_stream const* const in2,
+                                      unsigned char * const carry,
+                                      jarr_element_t * const buffer,
+                                      size_t const length_buffer)
+{
+    return jarr_stream_op(out, in1, in2, carry, jarr_stream_op_add, buffer,
+                          length_buffer);
+}
+
+enum jarr_file_status jarr_stream_lshift(struct jarr_stream * const out,
+                                         struct jarr_stream const* const in,
+                                         jarr_length_t const shift,
+                                         jarr_element_t * const buffer,
+                                         size_t const length_buffer)
+{
+    return jarr_stream_shift(out, in, shift, 0, buffer, length_buffer);
+}
+
+enum jarr_file_status jarr_stream_rshift(struct jarr_stream * const out,
+                                         struct jarr_stream const* const in,
+                                         jarr_length_t const shift,
+                                         jarr_element_t * const buffer,
+                                         size_t const length_buffer)
+{
+    return jarr_stream_shift(out, in, shift, 1, buffer, length_buffer);
+}
@@ -0,0 +1,83 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2014 Julian Ingram
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+ */
+
+#ifndef JARR_STREAM_H
+#define	JARR_STREAM_H
+
+#include "jarr.h"
+#include "jarr_file.h"
+
+// operations on jarrs in files too big to hold in memory. The inputs are read
+// and the output written a window at a time, with the carry of an add passed
+// on from one window to the next. A shift reads each output window from the
+// section of the input it comes from, so nothing is carried between windows.
+// The caller provides a buffer for the windows, which bounds the memory used,
+// the bigger it is the fewer reads and writes there are. The output must be
+// created with jarr_stream_create and not be one of the inputs, and all the
+// streams must be the same length
+
+enum jarr_file_status jarr_stream_bw_and(struct jarr_stream * const out,
+                                         struct jarr_stream const* const in1,
+                                         struct jarr_stream const* const in2,
+                                         jarr_element_t * const buffer,
+                                         size_t const length_buffer);
+enum jarr_file_status jarr_stream_bw_or(struct jarr_stream * const out,
+                                        struct jarr_stream const* const in1,
+                                        struct jarr_stream const* const in2,
+                                        jarr_element_t * const buffer,
+                                        size_t const length_buffer);
+enum jarr_file_status jarr_stream_bw_xor(struct jarr_stream * const out,
+                                         struct jarr_stream const* const in1,
+                                         struct jarr_stream const* const in2,
+                                         jarr_element_t * const buffer,
+                                         size_t const length_buffer);
+enum jarr_file_status jarr_stream_bw_andnot(struct jarr_stream * const out,
+                                            struct jarr_stream const* const
+                                            in1,
+                                            struct jarr_stream const* const
+                                            in2,
+                                            jarr_element_t * const buffer,
+                                            size_t const length_buffer);
+enum jarr_file_status jarr_stream_bw_not(struct jarr_stream * const out,
+                                         struct jarr_stream const* const in,
+                                         jarr_element_t * const buffer,
+                                         size_t const length_buffer);
+enum jarr_file_status jarr_stream_add(struct jarr_stream * const out,
+                                      struct jarr_stream const* const in1,
+                                      struct jarr_stream const* const in2,
+                                      unsigned char * const carry,
+                                      jarr_element_t * const buffer,
+                                      size_t const length_buffer);
+enum jarr_file_status jarr_stream_lshift(struct jarr_stream * const out,
+                                         struct jarr_stream const* const in,
+                                         jarr_length_t const shift,
+                                         jarr_element_t * const buffer,
+                                         size_t const length_buffer);
+enum jarr_file_status jarr_stream_rshift(struct jarr_stream * const out,
+                                         struct jarr_stream const* const in,
+                                         jarr_length_t const shift,
+                                         jarr_element_t * const buffer,
+                                         size_t const length_buffer);
+
+#endif
@@ -35,7 +35,22 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 
 # Object Files
 OBJECTFILES= \
-	${OBJECTDIR}/jarr.o
+	${OBJECTDIR}/jarr.o \
+	${OBJECTDIR}/jarr_alloc.o \
+	${OBJECTDIR}/jarr_atomic.o \
+	${OBJECTDIR}/jarr_batch.o \
+	${OBJECTDIR}/jarr_bloom.o \
+	${OBJECTDIR}/jarr_ewah.o \
+	${OBJECTDIR}/jarr_file.o \
+	${OBJECTDIR}/jarr_hash.o \
+	${OBJECTDIR}/jarr_matrix.o \
+	${OBJECTDIR}/jarr_mul.o \
+	${OBJECTDIR}/jarr_parallel.o \
+	${OBJECTDIR}/jarr_permute.o \
+	${OBJECTDIR}/jarr_rank.o \
+	${OBJECTDIR}/jarr_roaring.o \
+	${OBJECTDIR}/jarr_simd.o \
+	${OBJECTDIR}/jarr_stream.o
 
 # Test Directory
 TESTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}/tests
@@ -75,6 +90,81 @@ ${OBJECTDIR}/jarr.o: jarr.c
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr.o jarr.c
 
+${OBJECTDIR}/jarr_simd.o: jarr_simd.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_simd.o jarr_simd.c
+
+${OBJECTDIR}/jarr_rank.o: jarr_rank.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_rank.o jarr_rank.c
+
+${OBJECTDIR}/jarr_mul.o: jarr_mul.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_mul.o jarr_mul.c
+
+${OBJECTDIR}/jarr_roaring.o: jarr_roaring.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_roaring.o jarr_roaring.c
+
+${OBJECTDIR}/jarr_ewah.o: jarr_ewah.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_ewah.o jarr_ewah.c
+
+${OBJECTDIR}/jarr_file.o: jarr_file.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_file.o jarr_file.c
+
+${OBJECTDIR}/jarr_stream.o: jarr_stream.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_stream.o jarr_stream.c
+
+${OBJECTDIR}/jarr_parallel.o: jarr_parallel.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_parallel.o jarr_parallel.c
+
+${OBJECTDIR}/jarr_alloc.o: jarr_alloc.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_alloc.o jarr_alloc.c
+
+${OBJECTDIR}/jarr_atomic.o: jarr_atomic.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_atomic.o jarr_atomic.c
+
+${OBJECTDIR}/jarr_batch.o: jarr_batch.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_batch.o jarr_batch.c
+
+${OBJECTDIR}/jarr_permute.o: jarr_permute.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_permute.o jarr_permute.c
+
+${OBJECTDIR}/jarr_matrix.o: jarr_matrix.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_matrix.o jarr_matrix.c
+
+${OBJECTDIR}/jarr_bloom.o: jarr_bloom.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_bloom.o jarr_bloom.c
+
+${OBJECTDIR}/jarr_hash.o: jarr_hash.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_hash.o jarr_hash.c
+
 # Subprojects
 .build-subprojects:
 
@@ -82,7 +172,7 @@ ${OBJECTDIR}/jarr.o: jarr.c
 .build-tests-conf: .build-conf ${TESTFILES}
 ${TESTDIR}/TestFiles/f1: ${TESTDIR}/tests/jarr_test.o ${OBJECTFILES:%.o=%_nomain.o}
 	${MKDIR} -p ${TESTDIR}/TestFiles
-	${LINK.c}   -o ${TESTDIR}/TestFiles/f1 $^ ${LDLIBSOPTIONS} 
+	${LINK.c}   -o ${TESTDIR}/TestFiles/f1 $^ ${LDLIBSOPTIONS} -lpthread 
 
 
 ${TESTDIR}/tests/jarr_test.o: tests/jarr_test.c 
@@ -104,6 +194,201 @@ ${OBJECTDIR}/jarr_nomain.o: ${OBJECTDIR}/jarr.o jarr.c
 	    ${CP} ${OBJECTDIR}/jarr.o ${OBJECTDIR}/jarr_nomain.o;\
 	fi
 
+${OBJECTDIR}/jarr_simd_nomain.o: ${OBJECTDIR}/jarr_simd.o jarr_simd.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_simd.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_simd_nomain.o jarr_simd.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_simd.o ${OBJECTDIR}/jarr_simd_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_rank_nomain.o: ${OBJECTDIR}/jarr_rank.o jarr_rank.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_rank.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_rank_nomain.o jarr_rank.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_rank.o ${OBJECTDIR}/jarr_rank_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_mul_nomain.o: ${OBJECTDIR}/jarr_mul.o jarr_mul.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_mul.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_mul_nomain.o jarr_mul.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_mul.o ${OBJECTDIR}/jarr_mul_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_roaring_nomain.o: ${OBJECTDIR}/jarr_roaring.o jarr_roaring.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_roaring.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_roaring_nomain.o jarr_roaring.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_roaring.o ${OBJECTDIR}/jarr_roaring_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_ewah_nomain.o: ${OBJECTDIR}/jarr_ewah.o jarr_ewah.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_ewah.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_ewah_nomain.o jarr_ewah.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_ewah.o ${OBJECTDIR}/jarr_ewah_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_file_nomain.o: ${OBJECTDIR}/jarr_file.o jarr_file.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_file.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_file_nomain.o jarr_file.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_file.o ${OBJECTDIR}/jarr_file_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_stream_nomain.o: ${OBJECTDIR}/jarr_stream.o jarr_stream.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_stream.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_stream_nomain.o jarr_stream.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_stream.o ${OBJECTDIR}/jarr_stream_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_parallel_nomain.o: ${OBJECTDIR}/jarr_parallel.o jarr_parallel.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_parallel.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_parallel_nomain.o jarr_parallel.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_parallel.o ${OBJECTDIR}/jarr_parallel_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_alloc_nomain.o: ${OBJECTDIR}/jarr_alloc.o jarr_alloc.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_alloc.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_alloc_nomain.o jarr_alloc.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_alloc.o ${OBJECTDIR}/jarr_alloc_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_atomic_nomain.o: ${OBJECTDIR}/jarr_atomic.o jarr_atomic.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_atomic.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_atomic_nomain.o jarr_atomic.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_atomic.o ${OBJECTDIR}/jarr_atomic_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_batch_nomain.o: ${OBJECTDIR}/jarr_batch.o jarr_batch.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_batch.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_batch_nomain.o jarr_batch.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_batch.o ${OBJECTDIR}/jarr_batch_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_permute_nomain.o: ${OBJECTDIR}/jarr_permute.o jarr_permute.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_permute.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_permute_nomain.o jarr_permute.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_permute.o ${OBJECTDIR}/jarr_permute_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_matrix_nomain.o: ${OBJECTDIR}/jarr_matrix.o jarr_matrix.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_matrix.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_matrix_nomain.o jarr_matrix.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_matrix.o ${OBJECTDIR}/jarr_matrix_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_bloom_nomain.o: ${OBJECTDIR}/jarr_bloom.o jarr_bloom.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_bloom.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_bloom_nomain.o jarr_bloom.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_bloom.o ${OBJECTDIR}/jarr_bloom_nomain.o;\
+	fi
+
+${OBJECTDIR}/jarr_hash_nomain.o: ${OBJECTDIR}/jarr_hash.o jarr_hash.c 
+	${MKDIR} -p ${OBJECTDIR}
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/jarr_hash.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.c) -O2 -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/jarr_hash_nomain.o jarr_hash.c;\
+	else  \
+	    ${CP} ${OBJECTDIR}/jarr_hash.o ${OBJECTDIR}/jarr_hash_nomain.o;\
+	fi
+
 # Run Test Targets
 .test-conf:
 	@if [ "${TEST}" = "" ]; \
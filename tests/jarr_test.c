@@ -23,12 +23,29 @@ THE SOFTWARE.
  */
 
 #include "jarr.h"
-
+#include "jarr_alloc.h"
+#include "jarr_atomic.h"
+#include "jarr_batch.h"
+#include "jarr_bloom.h"
+#include "jarr_ewah.h"
+#include "jarr_file.h"
+#include "jarr_hash.h"
+#include "jarr_matrix.h"
+#include "jarr_parallel.h"
+#include "jarr_permute.h"
+#include "jarr_rank.h"
+#include "jarr_roaring.h"
+#include "jarr_stream.h"
+
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 #define BIT_MANIPULATIONS_LENGTH 	8192
+#define ELEMENT_BOUNDARY_REPS 		8192
 #define SECTION_CLEAR_LENGTH 		8192
 #define SECTION_CLEAR_REPS 		8192
 #define SECTION_SET_LENGTH 		8192
@@ -45,10 +62,57 @@ THE SOFTWARE.
 #define XOR_REPS 			8192
 #define NOT_LENGTH 			8192
 #define NOT_REPS 			8192
+#define BITWISE_ISA_LENGTH 		8192
+#define BITWISE_ISA_REPS 		8192
+#define POPCOUNT_LENGTH 		65536
+#define POPCOUNT_REPS 			2048
+#define RANK_LENGTH 			65536
+#define RANK_REPS 			128
+#define FIND_LENGTH 			65536
+#define FIND_REPS 			512
+#define TERNARY_LENGTH 			65536
+#define TERNARY_REPS 			512
 #define ADD_LENGTH 			8192
 #define ADD_REPS 			8192
 #define SUB_LENGTH 			8192
 #define SUB_REPS 			8192
+#define MUL_LENGTH 			6144
+#define MUL_REPS 			64
+#define ROARING_LENGTH 			300000
+#define ROARING_REPS 			32
+#define EWAH_LENGTH 			300000
+#define EWAH_REPS 			32
+#define FILE_LENGTH 			65536
+#define FILE_REPS 			64
+#define STREAM_LENGTH 			100000
+#define STREAM_REPS 			32
+#define PARALLEL_LENGTH 		262144
+#define PARALLEL_REPS 			256
+#define PARALLEL_THREADS 		3
+#define ALLOC_LENGTH 			4096
+#define ALLOC_REPS 			512
+#define ARENA_LENGTH 			4096
+#define ARENA_REPS 			64
+#define ATOMIC_LENGTH 			8192
+#define ATOMIC_REPS 			64
+#define ATOMIC_THREADS 			4
+#define BATCH_LENGTH 			65536
+#define BATCH_REPS 			256
+#define BATCH_INDICES 			2048
+#define ROTATE_LENGTH 			20000
+#define ROTATE_REPS 			512
+#define PERMUTE_LENGTH 			8192
+#define PERMUTE_REPS 			1024
+#define MATRIX_DIM 			200
+#define MATRIX_REPS 			64
+#define BLOOM_KEYS 			4096
+#define BLOOM_REPS 			64
+#define COMPARE_LENGTH 			4096
+#define COMPARE_REPS 			4096
+#define HASH_LENGTH 			256
+#define HASH_KEYS 			512
+#define HASH_CAPACITY 			256
+#define HASH_REPS 			32
 #define LSHIFT_LENGTH 			8192
 #define LSHIFT_REPS 			8192
 #define RSHIFT_LENGTH 			8192
@@ -197,6 +261,77 @@ void jarr_test_bit_maipulations(void)
     }
 }
 
+void jarr_test_element_boundaries(void)
+{
+    char test_str[] = "element boundaries";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < ELEMENT_BOUNDARY_REPS; ++i)
+    {
+        // lengths and shifts that sit exactly on or next to an element boundary
+        size_t length = ((rand_limited_nz(3) + 2) * jarr_element_length)
+                + rand_limited(3) - 1;
+        jarr_length_t shift = rand_limited_nz((unsigned int) (length
+                / jarr_element_length)) * jarr_element_length;
+        jarr_element_t arr[3][5];
+        struct jarr test[3] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length),
+            jarr_init(arr[2], length),
+        };
+
+        jassert((test[0].bme == length % jarr_element_length), test_str,
+                "incorrect bme");
+        jassert((test[0].length_elements == ((length + jarr_element_length
+                - 1) / jarr_element_length)), test_str,
+                "incorrect length_elements");
+
+        // a whole element set and cleared at an aligned position
+        jarr_clear_all(&test[0]);
+        jarr_set_section(&test[0], jarr_element_length, shift
+                - jarr_element_length);
+        jarr_length_t t;
+        for (t = 0; t < length; ++t)
+        {
+            jassert((jarr_read(&test[0], t) == ((t >= shift
+                    - jarr_element_length) && (t < shift))), test_str,
+                    "set section");
+        }
+        jarr_set_all(&test[0]);
+        jarr_clear_section(&test[0], jarr_element_length, shift
+                - jarr_element_length);
+        for (t = 0; t < length; ++t)
+        {
+            jassert((jarr_read(&test[0], t) != ((t >= shift
+                    - jarr_element_length) && (t < shift))), test_str,
+                    "clear section");
+        }
+
+        // shifts by whole elements
+        rand_array(&test[0]);
+        copy_array(&test[2], &test[0]);
+        jarr_lshift(&test[1], &test[0], shift);
+        for (t = 0; t < length; ++t)
+        {
+            jassert((jarr_read(&test[1], t) == ((t < shift) ? 0
+                    : jarr_read(&test[2], t - shift))), test_str, "lshift");
+        }
+        jarr_rshift(&test[1], &test[0], shift);
+        for (t = 0; t < length; ++t)
+        {
+            jassert((jarr_read(&test[1], t) == ((t < length - shift)
+                    ? jarr_read(&test[2], t + shift) : 0)), test_str,
+                    "rshift");
+        }
+
+        // the last element value must only contain bits below length_bits
+        jarr_set_all(&test[0]);
+        jassert(((jarr_get_lev(&test[0]) & ~test[0].mask) == 0), test_str,
+                "unmasked last element");
+    }
+}
+
 void jarr_test_section_clear(void)
 {
     char test_str[] = "section clear";
@@ -314,6 +449,7 @@ void jarr_test_section_read(void)
     unsigned int i;
     for (i = 0; i < SECTION_READ_REPS; ++i)
     {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
         // initialise a random array of random length
         jarr_element_t arr[SECTION_READ_LENGTH + (sizeof (jarr_element_t) * CHAR_BIT)
                 - 1 / (sizeof (jarr_element_t) * CHAR_BIT)];
@@ -373,6 +509,7 @@ void jarr_test_section_write(void)
     unsigned int i;
     for (i = 0; i < SECTION_WRITE_REPS; ++i)
     {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
         // initialise a random array of random length
         jarr_element_t arr[SECTION_WRITE_LENGTH + (sizeof (jarr_element_t) * CHAR_BIT)
                 - 1 / (sizeof (jarr_element_t) * CHAR_BIT)];
@@ -645,21 +782,24 @@ void jarr_test_not(void)
     }
 }
 
-void jarr_test_add(void)
+void jarr_test_bitwise_isa(void)
 {
-    char test_str[] = "add";
+    char test_str[] = "bitwise isa";
     printf("stest testing %s\n", test_str);
 
     unsigned int i;
-    for (i = 0; i < ADD_REPS; ++i)
+    for (i = 0; i < BITWISE_ISA_REPS; ++i)
     {
-        size_t length = rand_limited_nz(ADD_LENGTH);
-        jarr_element_t arr[5][ADD_LENGTH + (sizeof (jarr_element_t) * CHAR_BIT)
-                - 1 / (sizeof (jarr_element_t) * CHAR_BIT)];
+        // run a random instruction set on arrays starting at random offsets
+        // so that the unaligned heads and tails are exercised
+        enum jarr_isa isa = jarr_set_isa((enum jarr_isa) rand_limited(
+                jarr_isa_count));
+        size_t length = rand_limited_nz(BITWISE_ISA_LENGTH);
+        jarr_element_t arr[5][BITWISE_ISA_LENGTH + 16];
         struct jarr test[5] = {
-            jarr_init(arr[0], length),
-            jarr_init(arr[1], length),
-            jarr_init(arr[2], length),
+            jarr_init(arr[0] + rand_limited(16), length),
+            jarr_init(arr[1] + rand_limited(16), length),
+            jarr_init(arr[2] + rand_limited(16), length),
             jarr_init(arr[3], length),
             jarr_init(arr[4], length),
         };
@@ -668,7 +808,6 @@ void jarr_test_add(void)
         rand_array(&test[1]);
         rand_array(&test[2]);
 
-        // decide where to put the result
         struct jarr * args[3] = {
             &test[rand_limited(3)],
             &test[rand_limited(3)],
@@ -678,184 +817,2621 @@ void jarr_test_add(void)
         copy_array(&test[3], args[1]);
         copy_array(&test[4], args[2]);
 
-        unsigned char carry = rand_limited(2);
-        unsigned char carry_copy = carry;
+        unsigned int op = rand_limited(4);
+        switch (op)
+        {
+        case 0:
+            jarr_bw_and(args[0], args[1], args[2]);
+            break;
+        case 1:
+            jarr_bw_or(args[0], args[1], args[2]);
+            break;
+        case 2:
+            jarr_bw_xor(args[0], args[1], args[2]);
+            break;
+        default:
+            jarr_bw_not(args[0], args[1]);
+            break;
+        }
 
-        // perform the add
-        carry = jarr_add(args[0], args[1], args[2], carry);
+        jassert((jarr_get_isa() == isa), test_str, "isa not kept");
 
-        // perform a naive add
-        jarr_length_t index = 0;
-        while (index < length)
+        size_t e;
+        for (e = 0; e < test[3].length_elements; ++e)
         {
-            switch (jarr_read(&test[3], index)
-                    + jarr_read(&test[4], index) + carry_copy)
+            jarr_element_t expected;
+            switch (op)
             {
             case 0:
-                jarr_clear(&test[3], index);
-                carry_copy = 0;
+                expected = test[3].arr[e] & test[4].arr[e];
                 break;
             case 1:
-                jarr_set(&test[3], index);
-                carry_copy = 0;
+                expected = test[3].arr[e] | test[4].arr[e];
                 break;
             case 2:
-                jarr_clear(&test[3], index);
-                carry_copy = 1;
+                expected = test[3].arr[e] ^ test[4].arr[e];
                 break;
-            case 3:
-                jarr_set(&test[3], index);
-                carry_copy = 1;
+            default:
+                expected = ~test[3].arr[e];
                 break;
             }
-            ++index;
+            jassert((args[0]->arr[e] == expected), test_str, "");
         }
+    }
+}
 
-        while ((index < length) && carry_copy)
+void jarr_test_popcount(void)
+{
+    char test_str[] = "popcount";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < POPCOUNT_REPS; ++i)
+    {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        size_t length = rand_limited_nz(POPCOUNT_LENGTH);
+        jarr_element_t arr[(POPCOUNT_LENGTH / jarr_element_bits) + 16];
+        struct jarr test = jarr_init(arr + rand_limited(16), length);
+        rand_array(&test);
+
+        // sparse and dense arrays as well as random ones
+        switch (rand_limited(4))
         {
-            if (!jarr_read(&test[3], index))
-            {
-                jarr_set(&test[3], index);
-                carry_copy = 0;
-            }
-            else
-            {
-                jarr_clear(&test[3], index);
-            }
-            ++index;
+        case 0:
+            jarr_clear_all(&test);
+            jarr_set(&test, rand_limited((unsigned int) length));
+            break;
+        case 1:
+            jarr_set_all(&test);
+            break;
+        default:
+            break;
         }
 
-        jassert((carry == carry_copy), test_str, "incorrect carry");
-
-        unsigned int t;
+        jarr_length_t expected = 0;
+        jarr_length_t t;
         for (t = 0; t < length; ++t)
         {
-            jassert((jarr_read(args[0], t) == jarr_read(&test[3], t)),
-                    test_str, "");
+            expected += jarr_read(&test, t);
         }
+
+        jassert((jarr_popcount(&test) == expected), test_str, "");
     }
+
+    // a jarr of length 0 has no elements to read
+    struct jarr const empty = jarr_init(NULL, 0);
+    jassert((jarr_popcount(&empty) == 0), test_str, "empty");
 }
 
-void jarr_test_lshift(void)
+void jarr_test_popcount_section(void)
 {
-    char test_str[] = "left shift";
+    char test_str[] = "popcount section";
     printf("stest testing %s\n", test_str);
 
     unsigned int i;
-    for (i = 0; i < LSHIFT_REPS; ++i)
+    for (i = 0; i < POPCOUNT_REPS; ++i)
     {
-        size_t length;
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        size_t length = rand_limited_nz(POPCOUNT_LENGTH);
+        jarr_element_t arr[(POPCOUNT_LENGTH / jarr_element_bits) + 1];
+        struct jarr test = jarr_init(arr, length);
+        rand_array(&test);
+
+        // take 2 random points
+        jarr_length_t p1 = rand_limited(test.length_bits + 1);
+        jarr_length_t p2;
         do
         {
-            length = rand_limited_nz(LSHIFT_LENGTH);
+            p2 = rand_limited(test.length_bits + 1);
         }
-        while (length == 1);
-        jarr_element_t arr[3][LSHIFT_LENGTH + (sizeof (jarr_element_t)
-                * CHAR_BIT) - 1 / (sizeof (jarr_element_t) * CHAR_BIT)];
-        struct jarr test[3] = {
-            jarr_init(arr[0], length),
-            jarr_init(arr[1], length),
-            jarr_init(arr[2], length),
-        };
+        while (p1 == p2);
 
-        rand_array(&test[0]);
-        rand_array(&test[1]);
+        jarr_length_t from = (p1 < p2) ? p1 : p2;
+        jarr_length_t to = (p1 < p2) ? p2 : p1;
 
-        copy_array(&test[2], &test[0]);
+        jarr_length_t expected = 0;
+        jarr_length_t t;
+        for (t = from; t < to; ++t)
+        {
+            expected += jarr_read(&test, t);
+        }
 
-        // decide where to put the result
-        struct jarr* result = &test[rand_limited(2)];
+        jassert((jarr_popcount_section(&test, to - from, from) == expected),
+                test_str, "");
+    }
+}
 
-        // generate the shift
-        jarr_length_t shift = rand_limited_nz(length);
+// fills an array with bits set at a random density, including very sparse and
+// very dense arrays
 
-        // perform the lshift
-        jarr_lshift(result, &test[0], shift);
+void rand_density_array(struct jarr * const ja)
+{
+    unsigned int const density = rand_limited(6);
+    jarr_length_t i;
+    for (i = 0; i < ja->length_bits; ++i)
+    {
+        unsigned char bit;
+        switch (density)
+        {
+        case 0:
+            bit = rand_limited(256) == 0;
+            break;
+        case 1:
+            bit = rand_limited(256) != 0;
+            break;
+        case 2:
+            bit = 0;
+            break;
+        case 3:
+            bit = 1;
+            break;
+        default:
+            bit = rand_limited(2);
+            break;
+        }
+        if (bit)
+        {
+            jarr_set(ja, i);
+        }
+        else
+        {
+            jarr_clear(ja, i);
+        }
+    }
+}
 
-        unsigned int t;
-        for (t = 0; t < length; ++t)
+// checks a rank/select directory against a naive count
+
+void check_rank(struct jarr_rank const* const r, struct jarr const* const j,
+                char const* const test_str)
+{
+    jarr_length_t count = 0;
+    jarr_length_t t;
+    for (t = 0; t < j->length_bits; ++t)
+    {
+        if (rand_limited(16) == 0)
         {
-            if (t < shift)
+            jassert((jarr_rank(r, j, t) == count), test_str, "rank");
+        }
+        if (jarr_read(j, t))
+        {
+            if (rand_limited(4) == 0)
             {
-                jassert((jarr_read(result, t) == 0), test_str, "");
+                jassert((jarr_select(r, j, count) == t), test_str, "select");
+            }
+            ++count;
+        }
+    }
+    jassert((jarr_rank(r, j, j->length_bits) == count), test_str, "rank end");
+    jassert((r->count == count), test_str, "count");
+}
+
+void jarr_test_rank_select(void)
+{
+    char test_str[] = "rank select";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < RANK_REPS; ++i)
+    {
+        size_t length = rand_limited_nz(RANK_LENGTH);
+        jarr_element_t arr[(RANK_LENGTH / jarr_element_bits) + 1];
+        jarr_length_t superblocks[jarr_rank_superblocks_length(RANK_LENGTH)];
+        uint16_t blocks[jarr_rank_blocks_length(RANK_LENGTH)];
+        struct jarr test = jarr_init(arr, length);
+        rand_array(&test);
+        rand_density_array(&test);
+
+        struct jarr_rank r = jarr_rank_init(superblocks, blocks, &test);
+        check_rank(&r, &test, test_str);
+    }
+}
+
+void jarr_test_rank_update(void)
+{
+    char test_str[] = "rank update";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < RANK_REPS; ++i)
+    {
+        size_t length = rand_limited_nz(RANK_LENGTH);
+        jarr_element_t arr[(RANK_LENGTH / jarr_element_bits) + 1];
+        jarr_length_t superblocks[jarr_rank_superblocks_length(RANK_LENGTH)];
+        uint16_t blocks[jarr_rank_blocks_length(RANK_LENGTH)];
+        struct jarr test = jarr_init(arr, length);
+        rand_array(&test);
+        rand_density_array(&test);
+
+        struct jarr_rank r = jarr_rank_init(superblocks, blocks, &test);
+
+        unsigned int u;
+        for (u = 0; u < 4; ++u)
+        {
+            jarr_length_t p1 = rand_limited(test.length_bits + 1);
+            jarr_length_t p2;
+            do
+            {
+                p2 = rand_limited(test.length_bits + 1);
+            }
+            while (p1 == p2);
+
+            jarr_length_t from = (p1 < p2) ? p1 : p2;
+            jarr_length_t to = (p1 < p2) ? p2 : p1;
+
+            if (rand_limited(2))
+            {
+                jarr_set_section(&test, to - from, from);
             }
             else
             {
-                jassert((jarr_read(result, t) == jarr_read(&test[2],
-                                                           t - shift)),
-                        test_str, "");
+                jarr_clear_section(&test, to - from, from);
             }
+            jarr_rank_update(&r, &test, to - from, from);
         }
+        check_rank(&r, &test, test_str);
     }
 }
 
-void jarr_test_rshift(void)
+void jarr_test_find(void)
 {
-    char test_str[] = "right shift";
+    char test_str[] = "find";
     printf("stest testing %s\n", test_str);
 
     unsigned int i;
-    for (i = 0; i < RSHIFT_REPS; ++i)
+    for (i = 0; i < FIND_REPS; ++i)
     {
-        size_t length;
-        do
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        size_t length = rand_limited_nz(FIND_LENGTH);
+        jarr_element_t arr[(FIND_LENGTH / jarr_element_bits) + 1];
+        struct jarr test = jarr_init(arr, length);
+        rand_array(&test);
+        rand_density_array(&test);
+
+        jarr_length_t bit = rand_limited(test.length_bits + 1);
+
+        jarr_length_t t = bit;
+        while ((t < length) && !jarr_read(&test, t))
         {
-            length = rand_limited_nz(RSHIFT_LENGTH);
+            ++t;
         }
-        while (length == 1);
-        jarr_element_t arr[3][RSHIFT_LENGTH + (sizeof (jarr_element_t)
-                * CHAR_BIT) - 1 / (sizeof (jarr_element_t) * CHAR_BIT)];
-        struct jarr test[3] = {
+        jassert((jarr_find_next_set(&test, bit) == t), test_str, "next set");
+
+        t = bit;
+        while ((t < length) && jarr_read(&test, t))
+        {
+            ++t;
+        }
+        jassert((jarr_find_next_clear(&test, bit) == t), test_str,
+                "next clear");
+
+        t = (bit < length) ? bit + 1 : length;
+        while ((t > 0) && !jarr_read(&test, t - 1))
+        {
+            --t;
+        }
+        t = (t == 0) ? length : t - 1;
+        jassert((jarr_find_prev_set(&test, bit) == t), test_str, "prev set");
+    }
+}
+
+void jarr_test_foreach(void)
+{
+    char test_str[] = "foreach";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < FIND_REPS; ++i)
+    {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        size_t length = rand_limited_nz(FIND_LENGTH);
+        jarr_element_t arr[(FIND_LENGTH / jarr_element_bits) + 1];
+        struct jarr test = jarr_init(arr, length);
+        rand_array(&test);
+        rand_density_array(&test);
+
+        // every bit visited must be the next set bit
+        jarr_length_t expected = 0;
+        jarr_length_t bit;
+        struct jarr_iterator it;
+        jarr_foreach_set(bit, it, &test)
+        {
+            while (!jarr_read(&test, expected))
+            {
+                ++expected;
+                jassert((expected < length), test_str, "past the end");
+            }
+            jassert((bit == expected), test_str, "");
+            ++expected;
+        }
+        while (expected < length)
+        {
+            jassert(!jarr_read(&test, expected), test_str, "missed bit");
+            ++expected;
+        }
+    }
+}
+
+void jarr_test_andnot(void)
+{
+    char test_str[] = "andnot";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < AND_REPS; ++i)
+    {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        size_t length = rand_limited_nz(AND_LENGTH);
+        jarr_element_t arr[5][(AND_LENGTH / jarr_element_bits) + 1];
+        struct jarr test[5] = {
             jarr_init(arr[0], length),
             jarr_init(arr[1], length),
             jarr_init(arr[2], length),
+            jarr_init(arr[3], length),
+            jarr_init(arr[4], length),
         };
 
         rand_array(&test[0]);
         rand_array(&test[1]);
+        rand_array(&test[2]);
 
-        copy_array(&test[2], &test[0]);
-
-        // decide where to put the result
-        struct jarr* result = &test[rand_limited(2)];
+        struct jarr * args[3] = {
+            &test[rand_limited(3)],
+            &test[rand_limited(3)],
+            &test[rand_limited(3)],
+        };
 
-        // generate the shift
-        jarr_length_t shift = rand_limited_nz(length);
+        copy_array(&test[3], args[1]);
+        copy_array(&test[4], args[2]);
 
-        // perform the rshift
-        jarr_rshift(result, &test[0], shift);
+        jarr_bw_andnot(args[0], args[1], args[2]);
 
         unsigned int t;
         for (t = 0; t < length; ++t)
         {
-            if (t < (length - shift))
-            {
-                jassert((jarr_read(result, t) == jarr_read(&test[2],
-                                                           t + shift)),
-                        test_str, "");
-            }
-            else
-            {
-                jassert((jarr_read(result, t) == 0), test_str, "");
-            }
+            jassert((jarr_read(args[0], t) == (jarr_read(&test[3], t)
+                    && !jarr_read(&test[4], t))), test_str, "");
         }
     }
 }
 
-int main(int argc, char** argv)
+void jarr_test_ternary(void)
 {
-    printf("%%SUITE_STARTING%% jarr_test\n");
-    printf("stest testing jarr\n");
-    printf("%%SUITE_STARTED%%\n");
+    char test_str[] = "ternary";
+    printf("stest testing %s\n", test_str);
 
-    suite_start_time = clock();
+    unsigned int i;
+    for (i = 0; i < TERNARY_REPS; ++i)
+    {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        size_t length = rand_limited_nz(TERNARY_LENGTH);
+        unsigned int inputs = 3 + rand_limited(2);
+        jarr_element_t arr[8][(TERNARY_LENGTH / jarr_element_bits) + 1];
+        struct jarr test[8];
+        unsigned int a;
+        for (a = 0; a < 8; ++a)
+        {
+            test[a] = jarr_init(arr[a], length);
+            rand_array(&test[a]);
+        }
 
-    printf("%%TEST_STARTED%% test1 (jarr_test)\n");
+        // the output may be any of the inputs
+        struct jarr * args[5];
+        for (a = 0; a < 5; ++a)
+        {
+            args[a] = &test[rand_limited(4)];
+        }
+        for (a = 1; a < 5; ++a)
+        {
+            copy_array(&test[3 + a], args[a]);
+        }
+
+        unsigned int table = rand_limited(1U << (1U << inputs));
+        if (inputs == 3)
+        {
+            jarr_bw_ternary(args[0], args[1], args[2], args[3],
+                            (unsigned char) table);
+        }
+        else
+        {
+            jarr_bw_quaternary(args[0], args[1], args[2], args[3], args[4],
+                               (uint16_t) table);
+        }
+
+        jarr_length_t t;
+        for (t = 0; t < length; ++t)
+        {
+            unsigned int index = 0;
+            for (a = 0; a < inputs; ++a)
+            {
+                index = (index << 1) | jarr_read(&test[4 + a], t);
+            }
+            jassert((jarr_read(args[0], t) == ((table >> index) & 1U)),
+                    test_str, "");
+        }
+    }
+}
+
+void jarr_test_add(void)
+{
+    char test_str[] = "add";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < ADD_REPS; ++i)
+    {
+        size_t length = rand_limited_nz(ADD_LENGTH);
+        jarr_element_t arr[5][ADD_LENGTH + (sizeof (jarr_element_t) * CHAR_BIT)
+                - 1 / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[5] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length),
+            jarr_init(arr[2], length),
+            jarr_init(arr[3], length),
+            jarr_init(arr[4], length),
+        };
+
+        rand_array(&test[0]);
+        rand_array(&test[1]);
+        rand_array(&test[2]);
+
+        // decide where to put the result
+        struct jarr * args[3] = {
+            &test[rand_limited(3)],
+            &test[rand_limited(3)],
+            &test[rand_limited(3)],
+        };
+
+        copy_array(&test[3], args[1]);
+        copy_array(&test[4], args[2]);
+
+        unsigned char carry = rand_limited(2);
+        unsigned char carry_copy = carry;
+
+        // perform the add
+        carry = jarr_add(args[0], args[1], args[2], carry);
+
+        // perform a naive add
+        jarr_length_t index = 0;
+        while (index < length)
+        {
+            switch (jarr_read(&test[3], index)
+                    + jarr_read(&test[4], index) + carry_copy)
+            {
+            case 0:
+                jarr_clear(&test[3], index);
+                carry_copy = 0;
+                break;
+            case 1:
+                jarr_set(&test[3], index);
+                carry_copy = 0;
+                break;
+            case 2:
+                jarr_clear(&test[3], index);
+                carry_copy = 1;
+                break;
+            case 3:
+                jarr_set(&test[3], index);
+                carry_copy = 1;
+                break;
+            }
+            ++index;
+        }
+
+        while ((index < length) && carry_copy)
+        {
+            if (!jarr_read(&test[3], index))
+            {
+                jarr_set(&test[3], index);
+                carry_copy = 0;
+            }
+            else
+            {
+                jarr_clear(&test[3], index);
+            }
+            ++index;
+        }
+
+        jassert((carry == carry_copy), test_str, "incorrect carry");
+
+        unsigned int t;
+        for (t = 0; t < length; ++t)
+        {
+            jassert((jarr_read(args[0], t) == jarr_read(&test[3], t)),
+                    test_str, "");
+        }
+    }
+}
+
+void jarr_test_sub(void)
+{
+    char test_str[] = "sub";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < SUB_REPS; ++i)
+    {
+        size_t length = rand_limited_nz(SUB_LENGTH);
+        jarr_element_t arr[5][SUB_LENGTH + (sizeof (jarr_element_t) * CHAR_BIT)
+                - 1 / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[5] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length),
+            jarr_init(arr[2], length),
+            jarr_init(arr[3], length),
+            jarr_init(arr[4], length),
+        };
+
+        rand_array(&test[0]);
+        rand_array(&test[1]);
+        rand_array(&test[2]);
+
+        // long borrow chains
+        if (rand_limited(4) == 0)
+        {
+            jarr_clear_all(&test[rand_limited(3)]);
+        }
+
+        // decide where to put the result
+        struct jarr * args[3] = {
+            &test[rand_limited(3)],
+            &test[rand_limited(3)],
+            &test[rand_limited(3)],
+        };
+
+        copy_array(&test[3], args[1]);
+        copy_array(&test[4], args[2]);
+
+        unsigned char borrow = rand_limited(2);
+        unsigned char borrow_copy = borrow;
+
+        // perform the sub
+        borrow = jarr_sub(args[0], args[1], args[2], borrow);
+
+        // perform a naive sub
+        jarr_length_t index = 0;
+        while (index < length)
+        {
+            switch (2 + jarr_read(&test[3], index) - jarr_read(&test[4], index)
+                    - borrow_copy)
+            {
+            case 0:
+                jarr_clear(&test[3], index);
+                borrow_copy = 1;
+                break;
+            case 1:
+                jarr_set(&test[3], index);
+                borrow_copy = 1;
+                break;
+            case 2:
+                jarr_clear(&test[3], index);
+                borrow_copy = 0;
+                break;
+            case 3:
+                jarr_set(&test[3], index);
+                borrow_copy = 0;
+                break;
+            }
+            ++index;
+        }
+
+        jassert((borrow == borrow_copy), test_str, "incorrect borrow");
+
+        unsigned int t;
+        for (t = 0; t < length; ++t)
+        {
+            jassert((jarr_read(args[0], t) == jarr_read(&test[3], t)),
+                    test_str, "");
+        }
+    }
+}
+
+void jarr_test_lshift(void)
+{
+    char test_str[] = "left shift";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < LSHIFT_REPS; ++i)
+    {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        size_t length;
+        do
+        {
+            length = rand_limited_nz(LSHIFT_LENGTH);
+        }
+        while (length == 1);
+        jarr_element_t arr[3][LSHIFT_LENGTH + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1 / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[3] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length),
+            jarr_init(arr[2], length),
+        };
+
+        rand_array(&test[0]);
+        rand_array(&test[1]);
+
+        copy_array(&test[2], &test[0]);
+
+        // decide where to put the result
+        struct jarr* result = &test[rand_limited(2)];
+
+        // generate the shift
+        jarr_length_t shift = rand_limited_nz(length);
+
+        // perform the lshift
+        jarr_lshift(result, &test[0], shift);
+
+        unsigned int t;
+        for (t = 0; t < length; ++t)
+        {
+            if (t < shift)
+            {
+                jassert((jarr_read(result, t) == 0), test_str, "");
+            }
+            else
+            {
+                jassert((jarr_read(result, t) == jarr_read(&test[2],
+                                                           t - shift)),
+                        test_str, "");
+            }
+        }
+    }
+}
+
+void jarr_test_rshift(void)
+{
+    char test_str[] = "right shift";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < RSHIFT_REPS; ++i)
+    {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        size_t length;
+        do
+        {
+            length = rand_limited_nz(RSHIFT_LENGTH);
+        }
+        while (length == 1);
+        jarr_element_t arr[3][RSHIFT_LENGTH + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1 / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[3] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length),
+            jarr_init(arr[2], length),
+        };
+
+        rand_array(&test[0]);
+        rand_array(&test[1]);
+
+        copy_array(&test[2], &test[0]);
+
+        // decide where to put the result
+        struct jarr* result = &test[rand_limited(2)];
+
+        // generate the shift
+        jarr_length_t shift = rand_limited_nz(length);
+
+        // perform the rshift
+        jarr_rshift(result, &test[0], shift);
+
+        unsigned int t;
+        for (t = 0; t < length; ++t)
+        {
+            if (t < (length - shift))
+            {
+                jassert((jarr_read(result, t) == jarr_read(&test[2],
+                                                           t + shift)),
+                        test_str, "");
+            }
+            else
+            {
+                jassert((jarr_read(result, t) == 0), test_str, "");
+            }
+        }
+    }
+}
+
+void jarr_test_mul(void)
+{
+    char test_str[] = "mul";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < MUL_REPS; ++i)
+    {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        jarr_length_t a_length = rand_limited_nz(MUL_LENGTH);
+        jarr_length_t b_length = rand_limited_nz(MUL_LENGTH);
+        // sometimes multiply in place, into a or b
+        unsigned int const in_place = rand_limited(4);
+        jarr_length_t length = (in_place == 1) ? a_length : (in_place == 2)
+                ? b_length : rand_limited_nz(a_length + b_length + 1);
+        jarr_element_t arr[5][((2 * MUL_LENGTH) + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[5] = {
+            jarr_init(arr[0], a_length),
+            jarr_init(arr[1], b_length),
+            jarr_init(arr[2], length),
+            jarr_init(arr[3], length),
+            jarr_init(arr[4], length),
+        };
+        uint64_t scratch[jarr_mul_scratch_length(a_length, b_length)];
+
+        rand_density_array(&test[0]);
+        rand_density_array(&test[1]);
+
+        // the naive product, a shifted up one bit at a time and added in
+        // wherever b has a set bit
+        jarr_clear_all(&test[3]);
+        jarr_clear_all(&test[4]);
+        jarr_length_t t;
+        for (t = 0; (t < a_length) && (t < length); ++t)
+        {
+            if (jarr_read(&test[0], t))
+            {
+                jarr_set(&test[4], t);
+            }
+        }
+        for (t = 0; (t < b_length) && (t < length); ++t)
+        {
+            if (jarr_read(&test[1], t))
+            {
+                jarr_add(&test[3], &test[3], &test[4], 0);
+            }
+            jarr_lshift(&test[4], &test[4], 1);
+        }
+
+        struct jarr * const out = (in_place == 1) ? &test[0] : (in_place == 2)
+                ? &test[1] : &test[2];
+        jarr_mul(out, &test[0], &test[1], scratch);
+
+        for (t = 0; t < length; ++t)
+        {
+            jassert((jarr_read(out, t) == jarr_read(&test[3], t)), test_str,
+                    "");
+        }
+    }
+}
+
+// fills an array a compressed bitmap chunk at a time, each chunk is empty,
+// sparse, random, made of runs or full so every container type is used
+
+void rand_roaring_array(struct jarr * const ja)
+{
+    jarr_clear_all(ja);
+    jarr_length_t chunk;
+    for (chunk = 0; chunk < ja->length_bits; chunk += jarr_roaring_chunk_bits)
+    {
+        jarr_length_t end = chunk + jarr_roaring_chunk_bits;
+        if (end > ja->length_bits)
+        {
+            end = ja->length_bits;
+        }
+        jarr_length_t i;
+        switch (rand_limited(5))
+        {
+        case 0:
+            break;
+        case 1:
+            for (i = chunk; i < end; ++i)
+            {
+                if (rand_limited(64) == 0)
+                {
+                    jarr_set(ja, i);
+                }
+            }
+            break;
+        case 2:
+            for (i = chunk; i < end; ++i)
+            {
+                if (rand_limited(2))
+                {
+                    jarr_set(ja, i);
+                }
+            }
+            break;
+        case 3:
+            for (i = chunk; i < end; i += rand_limited_nz(4096))
+            {
+                jarr_length_t length = rand_limited_nz(2048);
+                if (length > end - i)
+                {
+                    length = end - i;
+                }
+                jarr_set_section(ja, length, i);
+                i += length;
+            }
+            break;
+        default:
+            jarr_set_section(ja, end - chunk, chunk);
+            break;
+        }
+    }
+}
+
+void jarr_test_roaring(void)
+{
+    char test_str[] = "roaring";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < ROARING_REPS; ++i)
+    {
+        jarr_length_t length = rand_limited_nz(ROARING_LENGTH);
+        jarr_element_t arr[4][(ROARING_LENGTH + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[4] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length),
+            jarr_init(arr[2], length),
+            jarr_init(arr[3], length),
+        };
+        size_t const containers_length = jarr_roaring_containers_length(length);
+        size_t const data_length = jarr_roaring_data_length(length);
+        struct jarr_roaring_container containers[3][containers_length];
+        uint16_t data[3][data_length];
+        struct jarr_roaring r[3] = {
+            jarr_roaring_init(containers[0], containers_length, data[0],
+                              data_length, length),
+            jarr_roaring_init(containers[1], containers_length, data[1],
+                              data_length, length),
+            jarr_roaring_init(containers[2], containers_length, data[2],
+                              data_length, length),
+        };
+
+        rand_roaring_array(&test[0]);
+        rand_roaring_array(&test[1]);
+
+        jassert(jarr_roaring_from_jarr(&r[0], &test[0]) == 0, test_str,
+                "out of space");
+        jassert(jarr_roaring_from_jarr(&r[1], &test[1]) == 0, test_str,
+                "out of space");
+        jassert(jarr_roaring_popcount(&r[0]) == jarr_popcount(&test[0]),
+                test_str, "popcount");
+        jarr_roaring_to_jarr(&test[2], &r[0]);
+        jassert(compare_arrays(&test[2], &test[0]), test_str, "round trip");
+        jarr_length_t t;
+        for (t = 0; t < 1024; ++t)
+        {
+            jarr_length_t const bit = rand_limited(length);
+            jassert(jarr_roaring_read(&r[1], bit) == jarr_read(&test[1], bit),
+                    test_str, "read");
+        }
+
+        // compressed with compressed
+        unsigned int op;
+        for (op = 0; op < 4; ++op)
+        {
+            unsigned char fail;
+            switch (op)
+            {
+            case 0:
+                fail = jarr_roaring_and(&r[2], &r[0], &r[1]);
+                jarr_bw_and(&test[3], &test[0], &test[1]);
+                break;
+            case 1:
+                fail = jarr_roaring_or(&r[2], &r[0], &r[1]);
+                jarr_bw_or(&test[3], &test[0], &test[1]);
+                break;
+            case 2:
+                fail = jarr_roaring_xor(&r[2], &r[0], &r[1]);
+                jarr_bw_xor(&test[3], &test[0], &test[1]);
+                break;
+            default:
+                fail = jarr_roaring_andnot(&r[2], &r[0], &r[1]);
+                jarr_bw_andnot(&test[3], &test[0], &test[1]);
+                break;
+            }
+            jassert(fail == 0, test_str, "out of space");
+            jarr_roaring_to_jarr(&test[2], &r[2]);
+            jassert(compare_arrays(&test[2], &test[3]), test_str, "op");
+            jassert(jarr_roaring_popcount(&r[2]) == jarr_popcount(&test[3]),
+                    test_str, "op popcount");
+        }
+
+        // compressed with dense into compressed
+        jassert(jarr_roaring_and_jarr(&r[2], &r[0], &test[1]) == 0, test_str,
+                "out of space");
+        jarr_bw_and(&test[3], &test[0], &test[1]);
+        jarr_roaring_to_jarr(&test[2], &r[2]);
+        jassert(compare_arrays(&test[2], &test[3]), test_str, "and jarr");
+        jassert(jarr_roaring_andnot_jarr(&r[2], &r[0], &test[1]) == 0,
+                test_str, "out of space");
+        jarr_bw_andnot(&test[3], &test[0], &test[1]);
+        jarr_roaring_to_jarr(&test[2], &r[2]);
+        jassert(compare_arrays(&test[2], &test[3]), test_str, "andnot jarr");
+
+        // dense with compressed into dense, sometimes in place
+        for (op = 0; op < 4; ++op)
+        {
+            struct jarr * const out = &test[2];
+            struct jarr const* const in = rand_limited(2) ? &test[2] : &test[0];
+            copy_array(&test[2], &test[0]);
+            switch (op)
+            {
+            case 0:
+                jarr_bw_and_roaring(out, in, &r[1]);
+                jarr_bw_and(&test[3], &test[0], &test[1]);
+                break;
+            case 1:
+                jarr_bw_or_roaring(out, in, &r[1]);
+                jarr_bw_or(&test[3], &test[0], &test[1]);
+                break;
+            case 2:
+                jarr_bw_xor_roaring(out, in, &r[1]);
+                jarr_bw_xor(&test[3], &test[0], &test[1]);
+                break;
+            default:
+                jarr_bw_andnot_roaring(out, in, &r[1]);
+                jarr_bw_andnot(&test[3], &test[0], &test[1]);
+                break;
+            }
+            jassert(compare_arrays(out, &test[3]), test_str, "bw roaring");
+        }
+
+        // running out of space is reported
+        if (jarr_popcount(&test[0]) != 0)
+        {
+            struct jarr_roaring small = jarr_roaring_init(containers[2],
+                                                          containers_length,
+                                                          data[2], 0, length);
+            jassert(jarr_roaring_from_jarr(&small, &test[0]) == 1, test_str,
+                    "no space");
+        }
+    }
+}
+
+void jarr_test_ewah(void)
+{
+    char test_str[] = "ewah";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < EWAH_REPS; ++i)
+    {
+        jarr_length_t length = rand_limited_nz(EWAH_LENGTH);
+        jarr_element_t arr[4][(EWAH_LENGTH + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[4] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length),
+            jarr_init(arr[2], length),
+            jarr_init(arr[3], length),
+        };
+        size_t const words_length = jarr_ewah_words_length(length);
+        uint64_t words[4][words_length];
+        struct jarr_ewah e[4] = {
+            jarr_ewah_init(words[0], words_length, length),
+            jarr_ewah_init(words[1], words_length, length),
+            jarr_ewah_init(words[2], words_length, length),
+            jarr_ewah_init(words[3], words_length, length),
+        };
+
+        unsigned int t;
+        for (t = 0; t < 2; ++t)
+        {
+            if (rand_limited(2))
+            {
+                rand_roaring_array(&test[t]);
+            }
+            else
+            {
+                rand_density_array(&test[t]);
+            }
+            jassert(jarr_ewah_from_jarr(&e[t], &test[t]) == 0, test_str,
+                    "out of space");
+            jarr_ewah_to_jarr(&test[2], &e[t]);
+            jassert(compare_arrays(&test[2], &test[t]), test_str,
+                    "round trip");
+        }
+
+        unsigned int op;
+        for (op = 0; op < 5; ++op)
+        {
+            unsigned char fail;
+            switch (op)
+            {
+            case 0:
+                fail = jarr_ewah_and(&e[2], &e[0], &e[1]);
+                jarr_bw_and(&test[3], &test[0], &test[1]);
+                break;
+            case 1:
+                fail = jarr_ewah_or(&e[2], &e[0], &e[1]);
+                jarr_bw_or(&test[3], &test[0], &test[1]);
+                break;
+            case 2:
+                fail = jarr_ewah_xor(&e[2], &e[0], &e[1]);
+                jarr_bw_xor(&test[3], &test[0], &test[1]);
+                break;
+            case 3:
+                fail = jarr_ewah_andnot(&e[2], &e[0], &e[1]);
+                jarr_bw_andnot(&test[3], &test[0], &test[1]);
+                break;
+            default:
+                fail = jarr_ewah_not(&e[2], &e[0]);
+                jarr_bw_not(&test[3], &test[0]);
+                break;
+            }
+            jassert(fail == 0, test_str, "out of space");
+            jarr_ewah_to_jarr(&test[2], &e[2]);
+            jassert(compare_arrays(&test[2], &test[3]), test_str, "op");
+
+            // results feed further ops, the negation must not leave bits set
+            // above length_bits
+            jassert(jarr_ewah_not(&e[3], &e[2]) == 0, test_str,
+                    "out of space");
+            jassert(jarr_ewah_xor(&e[2], &e[3], &e[1]) == 0, test_str,
+                    "out of space");
+            jarr_bw_not(&test[3], &test[3]);
+            jarr_bw_xor(&test[3], &test[3], &test[1]);
+            jarr_ewah_to_jarr(&test[2], &e[2]);
+            jassert(compare_arrays(&test[2], &test[3]), test_str, "chain");
+        }
+
+        // a run of clean words takes a single marker
+        jarr_clear_all(&test[2]);
+        jassert(jarr_ewah_from_jarr(&e[2], &test[2]) == 0, test_str,
+                "out of space");
+        jassert(e[2].length_words == 1, test_str, "clean run");
+
+        // running out of space is reported
+        struct jarr_ewah small = jarr_ewah_init(words[3], 0, length);
+        jassert(jarr_ewah_from_jarr(&small, &test[0]) == 1, test_str,
+                "no space");
+    }
+}
+
+// overwrites bytes of a file at an offset
+
+void patch_file(char const* const path, long const offset,
+                void const* const bytes, size_t const length)
+{
+    FILE* const file = fopen(path, "r+b");
+    fseek(file, offset, SEEK_SET);
+    fwrite(bytes, 1, length, file);
+    fclose(file);
+}
+
+void jarr_test_file(void)
+{
+    char test_str[] = "file";
+    printf("stest testing %s\n", test_str);
+
+    char path[] = "/tmp/jarr_test_XXXXXX";
+    int const fd = mkstemp(path);
+    jassert(fd >= 0, test_str, "mkstemp");
+    close(fd);
+
+    unsigned int i;
+    for (i = 0; i < FILE_REPS; ++i)
+    {
+        jarr_length_t length = rand_limited(FILE_LENGTH);
+        jarr_element_t arr[FILE_LENGTH + (sizeof (jarr_element_t) * CHAR_BIT)
+                - 1 / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test = jarr_init(arr, length);
+        struct jarr_file f;
+        rand_array(&test);
+
+        // read only
+        jassert(jarr_write_file(path, &test) == jarr_file_ok, test_str,
+                "write");
+        jassert(jarr_map_file(&f, path, jarr_file_read, 1) == jarr_file_ok,
+                test_str, "map");
+        jassert(compare_arrays(&f.j, &test), test_str, "contents");
+        jassert(jarr_checksum(&f.j) == jarr_checksum(&test), test_str,
+                "checksum");
+        jassert(jarr_unmap(&f) == jarr_file_ok, test_str, "unmap");
+
+        // writes through a read/write mapping reach the file
+        jassert(jarr_map_file(&f, path, jarr_file_read_write, 1)
+                == jarr_file_ok, test_str, "map");
+        unsigned int t;
+        for (t = 0; (t < 64) && (length != 0); ++t)
+        {
+            jarr_length_t const bit = rand_limited(length);
+            jarr_toggle(&f.j, bit);
+            jarr_toggle(&test, bit);
+        }
+        if (rand_limited(2))
+        {
+            jassert(jarr_file_sync(&f, rand_limited(2)) == jarr_file_ok,
+                    test_str, "sync");
+        }
+        jassert(jarr_unmap(&f) == jarr_file_ok, test_str, "unmap");
+        jassert(jarr_map_file(&f, path, jarr_file_read, 1) == jarr_file_ok,
+                test_str, "map after write");
+        jassert(compare_arrays(&f.j, &test), test_str, "written contents");
+        jassert(jarr_unmap(&f) == jarr_file_ok, test_str, "unmap");
+
+        // corruption is only noticed when verifying
+        if (length != 0)
+        {
+            unsigned char const flipped = *(unsigned char*) test.arr ^ 0x01U;
+            patch_file(path, jarr_file_header_size, &flipped, 1);
+            jassert(jarr_map_file(&f, path, jarr_file_read, 1)
+                    == jarr_file_error_checksum, test_str, "corrupt");
+            jassert(jarr_map_file(&f, path, jarr_file_read, 0) == jarr_file_ok,
+                    test_str, "map unverified");
+            jassert(jarr_unmap(&f) == jarr_file_ok, test_str, "unmap");
+        }
+
+        // created files are clear
+        jassert(jarr_create_file(path, length) == jarr_file_ok, test_str,
+                "create");
+        jassert(jarr_map_file(&f, path, jarr_file_read, 1) == jarr_file_ok,
+                test_str, "map created");
+        jassert(jarr_popcount(&f.j) == 0, test_str, "created contents");
+        jassert(jarr_unmap(&f) == jarr_file_ok, test_str, "unmap");
+
+        // files from a build with another element width are refused
+        uint32_t const width = jarr_element_bits * 2U;
+        patch_file(path, 24, &width, sizeof (width));
+        jassert(jarr_map_file(&f, path, jarr_file_read, 0)
+                == jarr_file_error_width, test_str, "width");
+    }
+
+    unlink(path);
+    jassert(jarr_map_file(&(struct jarr_file) {0}, path, jarr_file_read, 0)
+            == jarr_file_error_io, test_str, "missing");
+}
+
+void jarr_test_stream(void)
+{
+    char test_str[] = "stream";
+    printf("stest testing %s\n", test_str);
+
+    char paths[3][sizeof ("/tmp/jarr_test_XXXXXX")] = {
+        "/tmp/jarr_test_XXXXXX",
+        "/tmp/jarr_test_XXXXXX",
+        "/tmp/jarr_test_XXXXXX",
+    };
+    unsigned int i;
+    for (i = 0; i < 3; ++i)
+    {
+        int const fd = mkstemp(paths[i]);
+        jassert(fd >= 0, test_str, "mkstemp");
+        close(fd);
+    }
+
+    for (i = 0; i < STREAM_REPS; ++i)
+    {
+        jarr_length_t length = rand_limited_nz(STREAM_LENGTH);
+        jarr_element_t arr[3][(STREAM_LENGTH + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[3] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length),
+            jarr_init(arr[2], length),
+        };
+        // small buffers to get many windows
+        size_t const word_elements = 64U / (sizeof (jarr_element_t) * CHAR_BIT);
+        size_t const length_buffer = (2U * (2U + word_elements))
+                + rand_limited(64U * word_elements);
+        jarr_element_t buffer[length_buffer];
+        struct jarr_stream in[2];
+        struct jarr_stream out;
+        struct jarr_file f;
+
+        rand_density_array(&test[0]);
+        rand_density_array(&test[1]);
+        jassert(jarr_write_file(paths[0], &test[0]) == jarr_file_ok, test_str,
+                "write");
+        jassert(jarr_write_file(paths[1], &test[1]) == jarr_file_ok, test_str,
+                "write");
+        jassert(jarr_stream_open(&in[0], paths[0]) == jarr_file_ok, test_str,
+                "open");
+        jassert(jarr_stream_open(&in[1], paths[1]) == jarr_file_ok, test_str,
+                "open");
+
+        unsigned int op;
+        for (op = 0; op < 8; ++op)
+        {
+            jarr_length_t const shift = rand_limited(length + 64);
+            unsigned char carry = rand_limited(2);
+            unsigned char expected_carry = carry;
+            enum jarr_file_status status;
+            jarr_length_t t;
+            jassert(jarr_stream_create(&out, paths[2], length) == jarr_file_ok,
+                    test_str, "create");
+            switch (op)
+            {
+            case 0:
+                status = jarr_stream_bw_and(&out, &in[0], &in[1], buffer,
+                                            length_buffer);
+                jarr_bw_and(&test[2], &test[0], &test[1]);
+                break;
+            case 1:
+                status = jarr_stream_bw_or(&out, &in[0], &in[1], buffer,
+                                           length_buffer);
+                jarr_bw_or(&test[2], &test[0], &test[1]);
+                break;
+            case 2:
+                status = jarr_stream_bw_xor(&out, &in[0], &in[1], buffer,
+                                            length_buffer);
+                jarr_bw_xor(&test[2], &test[0], &test[1]);
+                break;
+            case 3:
+                status = jarr_stream_bw_andnot(&out, &in[0], &in[1], buffer,
+                                               length_buffer);
+                jarr_bw_andnot(&test[2], &test[0], &test[1]);
+                break;
+            case 4:
+                status = jarr_stream_bw_not(&out, &in[0], buffer,
+                                            length_buffer);
+                jarr_bw_not(&test[2], &test[0]);
+                break;
+            case 5:
+                status = jarr_stream_add(&out, &in[0], &in[1], &carry, buffer,
+                                         length_buffer);
+                expected_carry = jarr_add(&test[2], &test[0], &test[1],
+                                          expected_carry);
+                break;
+            case 6:
+                status = jarr_stream_lshift(&out, &in[0], shift, buffer,
+                                            length_buffer);
+                for (t = 0; t < length; ++t)
+                {
+                    if ((t >= shift) && jarr_read(&test[0], t - shift))
+                    {
+                        jarr_set(&test[2], t);
+                    }
+                    else
+                    {
+                        jarr_clear(&test[2], t);
+                    }
+                }
+                break;
+            default:
+                status = jarr_stream_rshift(&out, &in[0], shift, buffer,
+                                            length_buffer);
+                for (t = 0; t < length; ++t)
+                {
+                    if ((shift < length - t) && jarr_read(&test[0], t + shift))
+                    {
+                        jarr_set(&test[2], t);
+                    }
+                    else
+                    {
+                        jarr_clear(&test[2], t);
+                    }
+                }
+                break;
+            }
+            jassert(status == jarr_file_ok, test_str, "op");
+            jassert(carry == expected_carry, test_str, "carry");
+            jassert(jarr_stream_close(&out) == jarr_file_ok, test_str,
+                    "close");
+
+            // the checksum kept while writing must match the contents
+            jassert(jarr_map_file(&f, paths[2], jarr_file_read, 1)
+                    == jarr_file_ok, test_str, "map");
+            jassert(compare_arrays(&f.j, &test[2]), test_str, "contents");
+            jassert(jarr_unmap(&f) == jarr_file_ok, test_str, "unmap");
+        }
+
+        // a buffer too small for the windows, and streams of another length
+        jassert(jarr_stream_create(&out, paths[2], length) == jarr_file_ok,
+                test_str, "create");
+        jassert(jarr_stream_lshift(&out, &in[0], 1, buffer, (2U * (2U
+                                   + word_elements)) - 1U)
+                == jarr_file_error_buffer, test_str, "buffer");
+        jassert(jarr_stream_close(&out) == jarr_file_ok, test_str, "close");
+        jassert(jarr_stream_create(&out, paths[2], length + 1) == jarr_file_ok,
+                test_str, "create");
+        jassert(jarr_stream_bw_and(&out, &in[0], &in[1], buffer, length_buffer)
+                == jarr_file_error_length, test_str, "length");
+        jassert(jarr_stream_close(&out) == jarr_file_ok, test_str, "close");
+
+        // writing over what has been written keeps the checksum right, and a
+        // stream opened to be read cannot be written
+        jassert(jarr_stream_create(&out, paths[2], length) == jarr_file_ok,
+                test_str, "create");
+        jassert(jarr_stream_write(&out, &test[0], 0) == jarr_file_ok,
+                test_str, "write");
+        jassert(jarr_stream_write(&out, &test[1], 0) == jarr_file_ok,
+                test_str, "rewrite");
+        jassert(jarr_stream_close(&out) == jarr_file_ok, test_str, "close");
+        jassert(jarr_map_file(&f, paths[2], jarr_file_read, 1)
+                == jarr_file_ok, test_str, "rewrite map");
+        jassert(compare_arrays(&f.j, &test[1]), test_str, "rewrite contents");
+        jassert(jarr_unmap(&f) == jarr_file_ok, test_str, "unmap");
+        jassert(jarr_stream_write(&in[0], &test[1], 0) == jarr_file_error_mode,
+                test_str, "mode");
+
+        jassert(jarr_stream_close(&in[0]) == jarr_file_ok, test_str, "close");
+        jassert(jarr_stream_close(&in[1]) == jarr_file_ok, test_str, "close");
+    }
+
+    for (i = 0; i < 3; ++i)
+    {
+        unlink(paths[i]);
+    }
+}
+
+struct parallel_arg
+{
+    struct jarr_pool* pool;
+    struct jarr j;
+    jarr_length_t expected;
+    unsigned char ok;
+};
+
+// counts a jarr on a pool shared with other threads
+
+void* parallel_work(void* const arg)
+{
+    struct parallel_arg * const a = (struct parallel_arg*) arg;
+    unsigned int i;
+    a->ok = 1;
+    for (i = 0; i < PARALLEL_REPS; ++i)
+    {
+        if (jarr_par_popcount(a->pool, &a->j) != a->expected)
+        {
+            a->ok = 0;
+        }
+    }
+    return NULL;
+}
+
+void jarr_test_parallel(void)
+{
+    char test_str[] = "parallel";
+    printf("stest testing %s\n", test_str);
+
+    struct jarr_pool pool;
+    jassert(jarr_pool_init(&pool, PARALLEL_THREADS) == 0, test_str, "init");
+
+    unsigned int i;
+    for (i = 0; i < PARALLEL_REPS; ++i)
+    {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        // mostly split into many small chunks, sometimes serial
+        pool.serial_bytes = rand_limited(4) ? rand_limited(64)
+                : jarr_pool_serial_bytes;
+        struct jarr_pool * const p = rand_limited(8) ? &pool : NULL;
+        size_t const length = rand_limited_nz(PARALLEL_LENGTH);
+        size_t const line = 64 / sizeof (jarr_element_t);
+        jarr_element_t arr[5][((PARALLEL_LENGTH + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT))
+                + line];
+        // arrays that do not start on a cache line
+        struct jarr test[5] = {
+            jarr_init(arr[0] + rand_limited(line), length),
+            jarr_init(arr[1] + rand_limited(line), length),
+            jarr_init(arr[2] + rand_limited(line), length),
+            jarr_init(arr[3] + rand_limited(line), length),
+            jarr_init(arr[4] + rand_limited(line), length),
+        };
+        rand_array(&test[0]);
+        rand_array(&test[1]);
+        rand_array(&test[2]);
+        copy_array(&test[3], &test[2]);
+
+        jarr_length_t const startbit = rand_limited(length);
+        jarr_length_t const section = rand_limited(length - startbit) + 1;
+        unsigned char carry = rand_limited(2);
+        switch (rand_limited(12))
+        {
+        case 0:
+            jarr_par_bw_and(p, &test[2], &test[0], &test[1]);
+            jarr_bw_and(&test[3], &test[0], &test[1]);
+            break;
+        case 1:
+            jarr_par_bw_or(p, &test[2], &test[0], &test[1]);
+            jarr_bw_or(&test[3], &test[0], &test[1]);
+            break;
+        case 2:
+            jarr_par_bw_xor(p, &test[2], &test[2], &test[1]);
+            jarr_bw_xor(&test[3], &test[3], &test[1]);
+            break;
+        case 3:
+            jarr_par_bw_andnot(p, &test[2], &test[0], &test[1]);
+            jarr_bw_andnot(&test[3], &test[0], &test[1]);
+            break;
+        case 4:
+            jarr_par_bw_not(p, &test[2], &test[0]);
+            jarr_bw_not(&test[3], &test[0]);
+            break;
+        case 5:
+            jarr_par_clear_all(p, &test[2]);
+            jarr_clear_all(&test[3]);
+            break;
+        case 6:
+            jarr_par_set_all(p, &test[2]);
+            jarr_set_all(&test[3]);
+            break;
+        case 7:
+            jarr_par_clear_section(p, &test[2], section, startbit);
+            jarr_clear_section(&test[3], section, startbit);
+            break;
+        case 8:
+            jarr_par_set_section(p, &test[2], section, startbit);
+            jarr_set_section(&test[3], section, startbit);
+            break;
+        case 9:
+            jassert(jarr_par_popcount(p, &test[0]) == jarr_popcount(&test[0]),
+                    test_str, "popcount");
+            break;
+        case 10:
+            jassert(jarr_par_popcount_section(p, &test[0], section, startbit)
+                    == jarr_popcount_section(&test[0], section, startbit),
+                    test_str, "popcount section");
+            break;
+        default:
+            // carries that run across many chunks
+            if (rand_limited(2))
+            {
+                jarr_set_section(&test[0], section, startbit);
+                jarr_clear_section(&test[1], section, startbit);
+            }
+            copy_array(&test[4], &test[0]);
+            jassert(jarr_par_add(p, &test[2], &test[0], &test[1], carry)
+                    == jarr_add(&test[3], &test[4], &test[1], carry),
+                    test_str, "add carry");
+            break;
+        }
+        jassert(compare_arrays(&test[2], &test[3]), test_str, "");
+    }
+
+    // operations from several threads on one pool take turns
+    pool.serial_bytes = 0;
+    jarr_element_t arr[PARALLEL_THREADS][(PARALLEL_LENGTH + (sizeof
+            (jarr_element_t) * CHAR_BIT) - 1) / (sizeof (jarr_element_t)
+            * CHAR_BIT)];
+    struct parallel_arg args[PARALLEL_THREADS];
+    pthread_t threads[PARALLEL_THREADS];
+    size_t t;
+    for (t = 0; t < PARALLEL_THREADS; ++t)
+    {
+        args[t].pool = &pool;
+        args[t].j = jarr_init(arr[t], rand_limited_nz(PARALLEL_LENGTH));
+        rand_array(&args[t].j);
+        args[t].expected = jarr_popcount(&args[t].j);
+        jassert(pthread_create(&threads[t], NULL, parallel_work, &args[t])
+                == 0, test_str, "shared create");
+    }
+    for (t = 0; t < PARALLEL_THREADS; ++t)
+    {
+        pthread_join(threads[t], NULL);
+        jassert(args[t].ok, test_str, "shared");
+    }
+
+    jarr_pool_destroy(&pool);
+}
+
+// true if every bit from the end of j to the end of its aligned storage is clear
+
+int alloc_padding_clear(struct jarr const* const j)
+{
+    unsigned char const* const bytes = (unsigned char const*) j->arr;
+    jarr_length_t i;
+    for (i = j->length_bits; i < jarr_alloc_length(j->length_bits) * CHAR_BIT;
+            ++i)
+    {
+        if ((bytes[i / CHAR_BIT] >> (i % CHAR_BIT)) & 1U)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void jarr_test_alloc(void)
+{
+    char test_str[] = "alloc";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < ALLOC_REPS; ++i)
+    {
+        size_t const length = rand_limited(ALLOC_LENGTH);
+        struct jarr test = jarr_create(length);
+        jassert(test.arr != NULL, test_str, "create");
+        jassert(((uintptr_t) test.arr % jarr_alloc_align) == 0, test_str,
+                "create aligned");
+        jassert(alloc_padding_clear(&test), test_str, "create clear");
+        jassert(jarr_popcount(&test) == 0, test_str, "create cleared");
+
+        // the bits past the old length come back clear whether the jarr moves
+        // or not
+        rand_array(&test);
+        jarr_element_t arr[(ALLOC_LENGTH * 2 + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr expected = jarr_init(arr, length);
+        copy_array(&expected, &test);
+        size_t const shorter = rand_limited(length + 1);
+        jassert(jarr_resize(&test, shorter) == 0, test_str, "shrink");
+        size_t const longer = rand_limited(ALLOC_LENGTH * 2);
+        jassert(jarr_resize(&test, longer) == 0, test_str, "grow");
+        jassert(((uintptr_t) test.arr % jarr_alloc_align) == 0, test_str,
+                "resize aligned");
+        jassert(test.length_bits == longer, test_str, "resize length");
+        jarr_length_t j;
+        for (j = 0; j < longer; ++j)
+        {
+            jassert(jarr_read(&test, j) == ((j < shorter) ? jarr_read(&expected,
+                    j) : 0), test_str, "resize");
+        }
+        jassert(alloc_padding_clear(&test), test_str, "resize clear");
+        jarr_destroy(&test);
+        jassert(test.arr == NULL, test_str, "destroy");
+
+        // a destroyed jarr, or one whose creation failed, gets new storage
+        if (rand_limited(2))
+        {
+            test = jarr_init(NULL, length);
+        }
+        jassert(jarr_resize(&test, longer) == 0, test_str, "resize empty");
+        jassert((test.arr != NULL) && (test.length_bits == longer), test_str,
+                "resize empty length");
+        jassert(alloc_padding_clear(&test) && (jarr_popcount(&test) == 0),
+                test_str, "resize empty clear");
+        jarr_destroy(&test);
+    }
+
+    struct jarr_slab slab;
+    size_t const length = rand_limited(ALLOC_LENGTH);
+    jarr_slab_init(&slab, length, 1 + rand_limited(8));
+    struct jarr test[16];
+    for (i = 0; i < ALLOC_REPS; ++i)
+    {
+        size_t const n = 1 + rand_limited(16);
+        size_t j;
+        for (j = 0; j < n; ++j)
+        {
+            test[j] = jarr_slab_get(&slab);
+            jassert(test[j].arr != NULL, test_str, "slab get");
+            jassert(test[j].length_bits == length, test_str, "slab length");
+            jassert(((uintptr_t) test[j].arr % jarr_alloc_align) == 0,
+                    test_str, "slab aligned");
+            jassert(alloc_padding_clear(&test[j]), test_str, "slab clear");
+            jassert(jarr_popcount(&test[j]) == 0, test_str, "slab cleared");
+            size_t k;
+            for (k = 0; k < j; ++k)
+            {
+                jassert(test[j].arr != test[k].arr, test_str, "slab distinct");
+            }
+            // dirty it, padding included, for the next get
+            memset(test[j].arr, 0xff, jarr_alloc_length(length));
+        }
+        // the last jarr put back is the next one got
+        jarr_element_t * const first = test[0].arr;
+        while (j-- > 0)
+        {
+            jarr_slab_put(&slab, &test[j]);
+            jassert(test[j].arr == NULL, test_str, "slab put");
+        }
+        test[0] = jarr_slab_get(&slab);
+        jassert(test[0].arr == first, test_str, "slab reuse");
+        jarr_slab_put(&slab, &test[0]);
+    }
+    jarr_slab_destroy(&slab);
+}
+
+void jarr_test_arena(void)
+{
+    char test_str[] = "arena";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < ARENA_REPS; ++i)
+    {
+        // an arena over a buffer that does not start on a cache line
+        size_t const length = rand_limited(ARENA_LENGTH * 4);
+        unsigned char buffer[(ARENA_LENGTH * 4) + jarr_alloc_align];
+        size_t const skip = rand_limited(jarr_alloc_align);
+        struct jarr_arena arena;
+        jarr_arena_init(&arena, buffer + skip, length);
+        jassert(jarr_arena_mark(&arena) == 0, test_str, "init");
+
+        struct jarr test[32];
+        size_t mark = 0;
+        jarr_element_t* at_mark = NULL;
+        size_t n;
+        for (n = 0; n < 32; ++n)
+        {
+            if (rand_limited(8) == 0)
+            {
+                mark = jarr_arena_mark(&arena);
+                at_mark = NULL;
+            }
+            test[n] = jarr_arena_get(&arena, rand_limited(ARENA_LENGTH));
+            if (test[n].arr == NULL)
+            {
+                break;
+            }
+            if (at_mark == NULL)
+            {
+                at_mark = test[n].arr;
+            }
+            unsigned char const* const start = (unsigned char const*)
+                    test[n].arr;
+            jassert(((uintptr_t) start % jarr_alloc_align) == 0, test_str,
+                    "aligned");
+            jassert((start >= buffer + skip) && (start
+                    + jarr_alloc_length(test[n].length_bits) <= buffer + skip
+                    + length), test_str, "in buffer");
+            // overwriting one temporary leaves the others alone
+            rand_array(&test[n]);
+            jarr_element_t arr[(ARENA_LENGTH + (sizeof (jarr_element_t)
+                    * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+            struct jarr copy = jarr_init(arr, test[n].length_bits);
+            copy_array(&copy, &test[n]);
+            size_t k;
+            for (k = 0; k < n; ++k)
+            {
+                jarr_set_all(&test[k]);
+            }
+            jassert(compare_arrays(&test[n], &copy), test_str, "overlap");
+        }
+        jassert(jarr_arena_mark(&arena) <= length, test_str, "full");
+
+        // after a reset the same storage is handed out again
+        jarr_arena_reset(&arena, mark);
+        struct jarr const again = jarr_arena_get(&arena, 1);
+        jassert((at_mark == NULL) || (again.arr == at_mark), test_str,
+                "reset");
+        jarr_arena_reset(&arena, 0);
+        jassert(jarr_arena_alloc(&arena, length + 1) == NULL, test_str,
+                "too long");
+    }
+
+    // multiplying with scratch space from an arena, the heap or the caller
+    struct jarr_arena arena;
+    jassert(jarr_arena_create(&arena, jarr_mul_scratch_length(ARENA_LENGTH,
+            ARENA_LENGTH) * sizeof (uint64_t)) == 0, test_str, "create");
+    for (i = 0; i < ARENA_REPS; ++i)
+    {
+        jarr_length_t const a_length = rand_limited_nz(ARENA_LENGTH);
+        jarr_length_t const b_length = rand_limited_nz(ARENA_LENGTH);
+        jarr_length_t const length = rand_limited(a_length + b_length) + 1;
+        jarr_element_t arr[5][((2 * ARENA_LENGTH) + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[5] = {
+            jarr_init(arr[0], a_length),
+            jarr_init(arr[1], b_length),
+            jarr_init(arr[2], length),
+            jarr_init(arr[3], length),
+            jarr_init(arr[4], length),
+        };
+        uint64_t scratch[jarr_mul_scratch_length(a_length, b_length)];
+        rand_density_array(&test[0]);
+        rand_density_array(&test[1]);
+        jarr_mul(&test[2], &test[0], &test[1], scratch);
+        jassert(jarr_mul_arena(&test[3], &test[0], &test[1], &arena) == 0,
+                test_str, "mul arena");
+        jassert(jarr_arena_mark(&arena) == 0, test_str, "mul reset");
+        jassert(compare_arrays(&test[2], &test[3]), test_str, "mul");
+        jassert(jarr_mul_arena(&test[4], &test[0], &test[1], NULL) == 0,
+                test_str, "mul heap");
+        jassert(compare_arrays(&test[2], &test[4]), test_str, "mul heap");
+    }
+    struct jarr_arena small;
+    unsigned char buffer[jarr_alloc_align];
+    jarr_arena_init(&small, buffer, sizeof (buffer));
+    jarr_element_t arr[3][(ARENA_LENGTH + (sizeof (jarr_element_t) * CHAR_BIT)
+            - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+    struct jarr test[3] = {
+        jarr_init(arr[0], ARENA_LENGTH),
+        jarr_init(arr[1], ARENA_LENGTH),
+        jarr_init(arr[2], ARENA_LENGTH),
+    };
+    rand_array(&test[0]);
+    rand_array(&test[1]);
+    rand_array(&test[2]);
+    jarr_element_t const first = test[2].arr[0];
+    jassert(jarr_mul_arena(&test[2], &test[0], &test[1], &small) == 1,
+            test_str, "mul too full");
+    jassert(test[2].arr[0] == first, test_str, "mul unchanged");
+    jarr_arena_destroy(&arena);
+}
+
+struct atomic_worker
+{
+    struct jarr* j;
+    size_t thread;
+    unsigned char sections;
+    jarr_length_t seen;
+};
+
+// either sets this thread's interleaved bits and then takes every bit back with
+// test_and_clear, counting those it was first to, or sets its own section
+
+void* atomic_work(void* const arg)
+{
+    struct atomic_worker * const w = (struct atomic_worker*) arg;
+    jarr_length_t const length = w->j->length_bits;
+    if (w->sections)
+    {
+        jarr_length_t const start = (length * w->thread) / ATOMIC_THREADS;
+        jarr_length_t const end = (length * (w->thread + 1)) / ATOMIC_THREADS;
+        if (end != start)
+        {
+            jarr_atomic_set_section(w->j, end - start, start,
+                                    memory_order_release);
+        }
+        return NULL;
+    }
+    jarr_length_t i;
+    for (i = w->thread; i < length; i += ATOMIC_THREADS)
+    {
+        jarr_atomic_set(w->j, i, memory_order_relaxed);
+    }
+    for (i = 0; i < length; ++i)
+    {
+        w->seen += jarr_test_and_clear(w->j, i, memory_order_acq_rel);
+    }
+    return NULL;
+}
+
+void jarr_test_atomic(void)
+{
+    char test_str[] = "atomic";
+    printf("stest testing %s\n", test_str);
+
+    memory_order const orders[] = {memory_order_relaxed, memory_order_acquire,
+                                   memory_order_release, memory_order_acq_rel,
+                                   memory_order_seq_cst};
+    unsigned int i;
+    for (i = 0; i < ATOMIC_REPS * 16; ++i)
+    {
+        // against the plain operations
+        memory_order const order = orders[rand_limited(5)];
+        size_t const length = rand_limited_nz(ATOMIC_LENGTH);
+        jarr_element_t arr[2][(ATOMIC_LENGTH + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[2] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length),
+        };
+        rand_array(&test[0]);
+        copy_array(&test[1], &test[0]);
+        size_t const bit = rand_limited(length);
+        unsigned char const before = jarr_read(&test[0], bit);
+        switch (rand_limited(6))
+        {
+        case 0:
+            jarr_atomic_set(&test[0], bit, order);
+            jarr_set(&test[1], bit);
+            break;
+        case 1:
+            jarr_atomic_clear(&test[0], bit, order);
+            jarr_clear(&test[1], bit);
+            break;
+        case 2:
+            jarr_atomic_toggle(&test[0], bit, order);
+            jarr_toggle(&test[1], bit);
+            break;
+        case 3:
+            jassert(jarr_test_and_set(&test[0], bit, order) == before,
+                    test_str, "test and set");
+            jarr_set(&test[1], bit);
+            break;
+        case 4:
+            jassert(jarr_test_and_clear(&test[0], bit, order) == before,
+                    test_str, "test and clear");
+            jarr_clear(&test[1], bit);
+            break;
+        default:
+        {
+            size_t const startbit = rand_limited(length);
+            size_t const section = rand_limited(length - startbit) + 1;
+            if (rand_limited(2))
+            {
+                jarr_atomic_set_section(&test[0], section, startbit, order);
+                jarr_set_section(&test[1], section, startbit);
+            }
+            else
+            {
+                jarr_atomic_clear_section(&test[0], section, startbit, order);
+                jarr_clear_section(&test[1], section, startbit);
+            }
+            break;
+        }
+        }
+        jassert(compare_arrays(&test[0], &test[1]), test_str, "op");
+        jassert(jarr_atomic_read(&test[0], bit, memory_order_acquire)
+                == jarr_read(&test[1], bit), test_str, "read");
+    }
+
+    // threads sharing elements
+    for (i = 0; i < ATOMIC_REPS; ++i)
+    {
+        size_t const length = rand_limited_nz(ATOMIC_LENGTH);
+        jarr_element_t arr[(ATOMIC_LENGTH + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test = jarr_init(arr, length);
+        jarr_clear_all(&test);
+        pthread_t threads[ATOMIC_THREADS];
+        struct atomic_worker workers[ATOMIC_THREADS];
+        jarr_length_t seen = 0;
+        unsigned char sections;
+        for (sections = 0; sections < 2; ++sections)
+        {
+            size_t t;
+            for (t = 0; t < ATOMIC_THREADS; ++t)
+            {
+                workers[t].j = &test;
+                workers[t].thread = t;
+                workers[t].sections = sections;
+                workers[t].seen = 0;
+                jassert(pthread_create(&threads[t], NULL, atomic_work,
+                                       &workers[t]) == 0, test_str, "create");
+            }
+            for (t = 0; t < ATOMIC_THREADS; ++t)
+            {
+                pthread_join(threads[t], NULL);
+                seen += workers[t].seen;
+            }
+            // a bit still set had its set after every test_and_clear of it,
+            // otherwise exactly 1 thread saw it set
+            jassert(sections || (seen + jarr_popcount(&test) == length),
+                    test_str, "test and clear once");
+        }
+        jassert(jarr_popcount(&test) == length, test_str, "set section");
+    }
+}
+
+void jarr_test_batch(void)
+{
+    char test_str[] = "batch";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < BATCH_REPS; ++i)
+    {
+        size_t const length = rand_limited_nz(BATCH_LENGTH);
+        jarr_element_t arr[2][(BATCH_LENGTH + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[2] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length),
+        };
+        rand_array(&test[0]);
+        copy_array(&test[1], &test[0]);
+
+        // indices from a narrow window sometimes, so many share elements and
+        // repeat
+        size_t const n = rand_limited(BATCH_INDICES);
+        size_t const window = rand_limited(2) ? length : rand_limited(length)
+                + 1;
+        size_t const base = rand_limited(length - window + 1);
+        jarr_length_t indices[BATCH_INDICES];
+        jarr_length_t scratch[BATCH_INDICES];
+        size_t k;
+        for (k = 0; k < n; ++k)
+        {
+            indices[k] = base + rand_limited(window);
+        }
+        if (rand_limited(2))
+        {
+            jarr_sort_indices(indices, scratch, n, length);
+            for (k = 1; k < n; ++k)
+            {
+                jassert(indices[k - 1] <= indices[k], test_str, "sort");
+            }
+        }
+
+        unsigned char read[BATCH_INDICES];
+        switch (rand_limited(4))
+        {
+        case 0:
+            jarr_set_many(&test[0], indices, n);
+            for (k = 0; k < n; ++k)
+            {
+                jarr_set(&test[1], indices[k]);
+            }
+            break;
+        case 1:
+            jarr_clear_many(&test[0], indices, n);
+            for (k = 0; k < n; ++k)
+            {
+                jarr_clear(&test[1], indices[k]);
+            }
+            break;
+        case 2:
+            jarr_toggle_many(&test[0], indices, n);
+            for (k = 0; k < n; ++k)
+            {
+                jarr_toggle(&test[1], indices[k]);
+            }
+            break;
+        default:
+            jarr_read_many(&test[0], indices, n, read);
+            for (k = 0; k < n; ++k)
+            {
+                jassert(read[k] == jarr_read(&test[1], indices[k]), test_str,
+                        "read many");
+            }
+            break;
+        }
+        jassert(compare_arrays(&test[0], &test[1]), test_str, "op");
+    }
+
+    // the sort is a permutation
+    jarr_length_t indices[BATCH_INDICES];
+    jarr_length_t scratch[BATCH_INDICES];
+    size_t count[BATCH_INDICES] = {0};
+    size_t k;
+    for (k = 0; k < BATCH_INDICES; ++k)
+    {
+        indices[k] = rand_limited(BATCH_INDICES);
+        ++count[indices[k]];
+    }
+    jarr_sort_indices(indices, scratch, BATCH_INDICES, BATCH_INDICES);
+    for (k = 0; k < BATCH_INDICES; ++k)
+    {
+        jassert((k == 0) || (indices[k - 1] <= indices[k]), test_str, "sorted");
+        --count[indices[k]];
+    }
+    for (k = 0; k < BATCH_INDICES; ++k)
+    {
+        jassert(count[k] == 0, test_str, "permutation");
+    }
+}
+
+void jarr_test_rotate(void)
+{
+    char test_str[] = "rotate";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < ROTATE_REPS; ++i)
+    {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        // long enough to be rotated in place a chunk at a time sometimes
+        size_t const length = rand_limited(4) ? rand_limited_nz(ROTATE_LENGTH)
+                : rand_limited_nz(256);
+        jarr_element_t arr[3][(ROTATE_LENGTH + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[3] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length),
+            jarr_init(arr[2], length),
+        };
+        rand_array(&test[0]);
+        rand_array(&test[1]);
+        copy_array(&test[2], &test[0]);
+
+        struct jarr * const result = &test[rand_limited(2)];
+        jarr_length_t const shift = rand_limited(2 * length);
+        unsigned char const left = (unsigned char) rand_limited(2);
+        if (left)
+        {
+            jarr_rotl(result, &test[0], shift);
+        }
+        else
+        {
+            jarr_rotr(result, &test[0], shift);
+        }
+
+        jarr_length_t t;
+        for (t = 0; t < length; ++t)
+        {
+            jarr_length_t const from = left ? (t + length - (shift % length))
+                    % length : (t + shift) % length;
+            jassert(jarr_read(result, t) == jarr_read(&test[2], from),
+                    test_str, left ? "left" : "right");
+        }
+    }
+}
+
+void jarr_test_permute(void)
+{
+    char test_str[] = "permute";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < PERMUTE_REPS; ++i)
+    {
+        // the table fallback as well as pext and pdep
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        size_t const length = rand_limited_nz(PERMUTE_LENGTH);
+        jarr_element_t arr[5][(PERMUTE_LENGTH + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[5] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length),
+            jarr_init(arr[2], length),
+            jarr_init(arr[3], length),
+            jarr_init(arr[4], length),
+        };
+        rand_array(&test[0]);
+        rand_density_array(&test[1]);
+        rand_array(&test[2]);
+
+        // compress, sometimes into a jarr too short to hold it all
+        jarr_length_t const count = jarr_popcount(&test[1]);
+        struct jarr out = jarr_init(arr[2], rand_limited(2) ? length
+                                    : rand_limited(length) + 1);
+        jassert(jarr_compress(&out, &test[0], &test[1]) == count, test_str,
+                "compress count");
+        jarr_length_t t;
+        jarr_length_t k = 0;
+        for (t = 0; t < length; ++t)
+        {
+            if (jarr_read(&test[1], t))
+            {
+                jassert((k >= out.length_bits) || (jarr_read(&out, k)
+                        == jarr_read(&test[0], t)), test_str, "compress");
+                ++k;
+            }
+        }
+        for (; k < out.length_bits; ++k)
+        {
+            jassert(jarr_read(&out, k) == 0, test_str, "compress clear");
+        }
+
+        // expand, from random bits
+        rand_array(&test[2]);
+        struct jarr const in = jarr_init(arr[2], count);
+        rand_array(&test[3]);
+        jarr_expand(&test[3], &in, &test[1]);
+        k = 0;
+        for (t = 0; t < length; ++t)
+        {
+            if (jarr_read(&test[1], t))
+            {
+                jassert(jarr_read(&test[3], t) == jarr_read(&in, k), test_str,
+                        "expand");
+                ++k;
+            }
+            else
+            {
+                jassert(jarr_read(&test[3], t) == 0, test_str, "expand clear");
+            }
+        }
+
+        // reverse and byteswap, sometimes in place
+        copy_array(&test[4], &test[0]);
+        struct jarr * const result = &test[rand_limited(2) ? 3 : 0];
+        jarr_reverse(result, &test[0]);
+        for (t = 0; t < length; ++t)
+        {
+            jassert(jarr_read(result, t) == jarr_read(&test[4], length - 1 - t),
+                    test_str, "reverse");
+        }
+        copy_array(&test[0], &test[4]);
+        jarr_byteswap(result, &test[0]);
+        size_t e;
+        for (e = 0; e < test[4].length_elements; ++e)
+        {
+            unsigned char const* const from = (unsigned char const*)
+                    (test[4].arr + e);
+            unsigned char const* const to = (unsigned char const*)
+                    (result->arr + e);
+            size_t b;
+            for (b = 0; b < sizeof (jarr_element_t); ++b)
+            {
+                jassert(to[b] == from[sizeof (jarr_element_t) - 1 - b],
+                        test_str, "byteswap");
+            }
+        }
+    }
+}
+
+// random bits in every row of m, the padding left 0
+
+void rand_matrix(struct jarr_matrix * const m)
+{
+    jarr_matrix_clear(m);
+    size_t r;
+    for (r = 0; r < m->rows; ++r)
+    {
+        struct jarr row = jarr_matrix_row(m, r);
+        rand_density_array(&row);
+        *row.last_element = jarr_get_lev(&row);
+    }
+}
+
+unsigned char matrix_read(struct jarr_matrix const* const m, size_t const r,
+                          jarr_length_t const c)
+{
+    struct jarr const row = jarr_matrix_row(m, r);
+    return jarr_read(&row, c);
+}
+
+// 1 if the padding of every row of m is 0
+
+unsigned char matrix_padding_clear(struct jarr_matrix const* const m)
+{
+    size_t r;
+    for (r = 0; r < m->rows; ++r)
+    {
+        struct jarr const row = jarr_matrix_row(m, r);
+        if (*row.last_element != jarr_get_lev(&row))
+        {
+            return 0;
+        }
+        size_t e;
+        for (e = row.length_elements; e < m->stride; ++e)
+        {
+            if (row.arr[e] != 0)
+            {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// rank by elimination a bit at a time, m is changed
+
+size_t matrix_rank_naive(struct jarr_matrix * const m)
+{
+    size_t rank = 0;
+    jarr_length_t c;
+    for (c = 0; (c < m->cols) && (rank < m->rows); ++c)
+    {
+        size_t pivot = rank;
+        while ((pivot < m->rows) && !matrix_read(m, pivot, c))
+        {
+            ++pivot;
+        }
+        if (pivot == m->rows)
+        {
+            continue;
+        }
+        struct jarr p = jarr_matrix_row(m, pivot);
+        struct jarr q = jarr_matrix_row(m, rank);
+        size_t r;
+        for (r = rank; r < m->rows; ++r)
+        {
+            struct jarr row = jarr_matrix_row(m, r);
+            if ((r != pivot) && jarr_read(&row, c))
+            {
+                jarr_length_t k;
+                for (k = 0; k < m->cols; ++k)
+                {
+                    if (jarr_read(&p, k))
+                    {
+                        jarr_toggle(&row, k);
+                    }
+                }
+            }
+        }
+        jarr_length_t k;
+        for (k = 0; k < m->cols; ++k)
+        {
+            unsigned char const bit = jarr_read(&p, k);
+            if (jarr_read(&q, k))
+            {
+                jarr_set(&p, k);
+            }
+            else
+            {
+                jarr_clear(&p, k);
+            }
+            if (bit)
+            {
+                jarr_set(&q, k);
+            }
+            else
+            {
+                jarr_clear(&q, k);
+            }
+        }
+        ++rank;
+    }
+    return rank;
+}
+
+void jarr_test_matrix(void)
+{
+    char test_str[] = "matrix";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < MATRIX_REPS; ++i)
+    {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        size_t const n = rand_limited_nz(MATRIX_DIM);
+        size_t const k = rand_limited_nz(MATRIX_DIM);
+        size_t const m = rand_limited_nz(MATRIX_DIM);
+        size_t const length = jarr_matrix_length(MATRIX_DIM, MATRIX_DIM);
+        jarr_element_t arr[5][length];
+        struct jarr_matrix a = jarr_matrix_init(arr[0], n, k);
+        struct jarr_matrix b = jarr_matrix_init(arr[1], k, m);
+        struct jarr_matrix c = jarr_matrix_init(arr[2], n, m);
+        jassert((a.stride * sizeof (jarr_element_t)) % jarr_matrix_align == 0,
+                test_str, "stride");
+        rand_matrix(&a);
+        rand_matrix(&b);
+
+        // transpose, and back again
+        struct jarr_matrix at = jarr_matrix_init(arr[3], k, n);
+        memset(arr[3], 0xa5, sizeof (arr[3]));
+        jarr_matrix_transpose(&at, &a);
+        size_t r;
+        jarr_length_t t;
+        for (r = 0; r < n; ++r)
+        {
+            for (t = 0; t < k; ++t)
+            {
+                jassert(matrix_read(&a, r, t) == matrix_read(&at, t, r),
+                        test_str, "transpose");
+            }
+        }
+        jassert(matrix_padding_clear(&at), test_str, "transpose padding");
+        struct jarr_matrix att = jarr_matrix_init(arr[4], n, k);
+        jarr_matrix_transpose(&att, &at);
+        jassert(memcmp(att.arr, a.arr, jarr_matrix_length(n, k)
+                * sizeof (jarr_element_t)) == 0, test_str, "transpose twice");
+
+        // multiply, against the sum of each row of b picked by a
+        jarr_element_t scratch[jarr_matrix_mul_scratch_length(&b)];
+        memset(arr[2], 0xa5, sizeof (arr[2]));
+        jarr_matrix_mul(&c, &a, &b, scratch);
+        for (r = 0; r < n; ++r)
+        {
+            for (t = 0; t < m; ++t)
+            {
+                unsigned char bit = 0;
+                size_t s;
+                for (s = 0; s < k; ++s)
+                {
+                    bit ^= matrix_read(&a, r, s) & matrix_read(&b, s, t);
+                }
+                jassert(matrix_read(&c, r, t) == bit, test_str, "mul");
+            }
+        }
+        jassert(matrix_padding_clear(&c), test_str, "mul padding");
+
+        // rank of the product, which is at most k, and of its transpose
+        struct jarr_matrix copy = jarr_matrix_init(arr[3], n, m);
+        memcpy(copy.arr, c.arr, jarr_matrix_length(n, m)
+               * sizeof (jarr_element_t));
+        size_t const rank = matrix_rank_naive(&copy);
+        jassert(rank <= k, test_str, "rank bound");
+        struct jarr_matrix ct = jarr_matrix_init(arr[4], m, n);
+        jarr_matrix_transpose(&ct, &c);
+        jassert(jarr_matrix_rank(&ct) == rank, test_str, "rank transpose");
+        memcpy(copy.arr, c.arr, jarr_matrix_length(n, m)
+               * sizeof (jarr_element_t));
+        jassert(jarr_matrix_rank(&copy) == rank, test_str, "rank");
+
+        // reduced row echelon form, each pivot the only bit in its column
+        jassert(jarr_matrix_echelon(&c, 1) == rank, test_str, "echelon rank");
+        jassert(matrix_padding_clear(&c), test_str, "echelon padding");
+        t = 0;
+        for (r = 0; r < n; ++r)
+        {
+            while ((t < m) && !matrix_read(&c, r, t))
+            {
+                ++t;
+            }
+            jassert((t < m) == (r < rank), test_str, "echelon pivot");
+            if (t < m)
+            {
+                size_t s;
+                for (s = 0; s < n; ++s)
+                {
+                    jassert(matrix_read(&c, s, t) == (s == r), test_str,
+                            "echelon reduced");
+                }
+            }
+        }
+    }
+}
+
+uint64_t rand_hash(void)
+{
+    uint64_t h = 0;
+    size_t i;
+    for (i = 0; i < sizeof (h); ++i)
+    {
+        h = (h << CHAR_BIT) | rand_char();
+    }
+    return h;
+}
+
+void jarr_test_bloom(void)
+{
+    char test_str[] = "bloom";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < BLOOM_REPS; ++i)
+    {
+        size_t const keys = rand_limited_nz(BLOOM_KEYS);
+        size_t const blocks = jarr_bloom_blocks(keys, 16U);
+        unsigned int const k = rand_limited_nz(jarr_bloom_max_k + 1U);
+        size_t const length = jarr_bloom_length(blocks);
+        // room for a header before the elements of the serialised filter
+        size_t const header = jarr_bloom_header_size
+                / sizeof (jarr_element_t);
+        jarr_element_t arr[2][header + length];
+        uint64_t hashes[2][keys];
+        unsigned char found[keys];
+        size_t t;
+        for (t = 0; t < keys; ++t)
+        {
+            hashes[0][t] = rand_hash();
+            hashes[1][t] = rand_hash();
+        }
+
+        // one key sets k bits in one block
+        struct jarr_bloom b = jarr_bloom_init(arr[0] + header, blocks, k);
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        jarr_bloom_insert(&b, hashes[0][0]);
+        jassert(jarr_popcount(&b.bits) == k, test_str, "insert count");
+        jarr_length_t const first = jarr_find_next_set(&b.bits, 0);
+        jarr_length_t const last = jarr_find_prev_set(&b.bits,
+                                                      b.bits.length_bits);
+        jassert(first / jarr_bloom_block_bits == last / jarr_bloom_block_bits,
+                test_str, "insert block");
+
+        // the same filter whatever the instruction set, one at a time or in a
+        // batch
+        struct jarr_bloom c = jarr_bloom_init(arr[1] + header, blocks, k);
+        for (t = 0; t < keys; ++t)
+        {
+            jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+            jarr_bloom_insert(&c, hashes[0][t]);
+        }
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        jarr_bloom_insert_many(&b, hashes[0], keys);
+        jassert(memcmp(b.bits.arr, c.bits.arr, length
+                * sizeof (jarr_element_t)) == 0, test_str, "isa");
+
+        // no false negatives, and few false positives
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        jassert(jarr_bloom_query_many(&b, hashes[0], keys, found) == keys,
+                test_str, "query many");
+        size_t positives = 0;
+        for (t = 0; t < keys; ++t)
+        {
+            jassert(found[t] == 1, test_str, "query found");
+            jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+            jassert(jarr_bloom_query(&b, hashes[0][t]) == 1, test_str,
+                    "query");
+            positives += jarr_bloom_query(&b, hashes[1][t]);
+        }
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        jassert(jarr_bloom_query_many(&b, hashes[1], keys, NULL) == positives,
+                test_str, "query many count");
+        jassert((keys < 1024U) || (positives * 10U < keys), test_str,
+                "false positives");
+
+        // serialised in place, then loaded
+        jarr_bloom_header(&b, (unsigned char*) arr[0]);
+        struct jarr_bloom loaded;
+        size_t const bytes = jarr_bloom_serialised_length(&b);
+        jassert(jarr_bloom_load(&loaded, arr[0], bytes) == 0, test_str,
+                "load");
+        jassert((loaded.bits.arr == b.bits.arr) && (loaded.blocks == blocks)
+                && (loaded.k == k), test_str, "load filter");
+        jassert(jarr_bloom_query_many(&loaded, hashes[1], keys, NULL)
+                == positives, test_str, "load query");
+        jassert(jarr_bloom_load(&loaded, arr[0], bytes - 1U) == 1, test_str,
+                "load short");
+        ((unsigned char*) arr[0])[0] ^= 1U;
+        jassert(jarr_bloom_load(&loaded, arr[0], bytes) == 1, test_str,
+                "load magic");
+    }
+}
+
+void jarr_test_compare(void)
+{
+    char test_str[] = "compare";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < COMPARE_REPS; ++i)
+    {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        size_t const length = rand_limited(COMPARE_LENGTH);
+        jarr_element_t arr[2][(COMPARE_LENGTH + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT)];
+        struct jarr test[2] = {
+            jarr_init(arr[0], length),
+            jarr_init(arr[1], length)
+        };
+        if (length != 0)
+        {
+            // the same bits, or differing from a random bit up, sometimes
+            // just in one
+            rand_array(&test[0]);
+            copy_array(&test[1], &test[0]);
+            unsigned int const differ = rand_limited(3);
+            if (differ != 0)
+            {
+                jarr_length_t const bit = rand_limited(length);
+                jarr_toggle(&test[1], bit);
+                if (differ == 2)
+                {
+                    rand_array(&test[1]);
+                }
+            }
+            // different garbage above length_bits
+            *test[0].last_element |= ~test[0].mask;
+            *test[1].last_element &= test[1].mask;
+        }
+        unsigned char equal = 1;
+        int compare = 0;
+        jarr_length_t t = length;
+        while (t != 0)
+        {
+            --t;
+            unsigned char const a = jarr_read(&test[0], t);
+            unsigned char const b = jarr_read(&test[1], t);
+            if (a != b)
+            {
+                equal = 0;
+                compare = (a < b) ? -1 : 1;
+                break;
+            }
+        }
+        jassert(jarr_equal(&test[0], &test[1]) == equal, test_str, "equal");
+        jassert(jarr_compare(&test[0], &test[1]) == compare, test_str,
+                "compare");
+        jassert(jarr_compare(&test[1], &test[0]) == -compare, test_str,
+                "compare swapped");
+        struct jarr const shorter = jarr_init(arr[1], rand_limited(length + 1));
+        jassert((shorter.length_bits == length) || !jarr_equal(&test[0],
+                &shorter), test_str, "equal length");
+
+        // all clear or all set but for maybe one bit
+        unsigned char const ones = (unsigned char) rand_limited(2);
+        if (ones)
+        {
+            jarr_set_all(&test[0]);
+        }
+        else
+        {
+            jarr_clear_all(&test[0]);
+        }
+        unsigned char const flip = (length != 0) && rand_limited(2);
+        if (flip)
+        {
+            jarr_toggle(&test[0], rand_limited(length));
+        }
+        if (length != 0)
+        {
+            *test[0].last_element ^= ~test[0].mask;
+        }
+        jarr_length_t const count = (length == 0) ? 0
+                : jarr_popcount(&test[0]);
+        jassert(jarr_is_zero(&test[0]) == (count == 0), test_str, "is zero");
+        jassert(jarr_is_all_ones(&test[0]) == (count == length), test_str,
+                "is all ones");
+    }
+}
+
+void jarr_test_hash(void)
+{
+    char test_str[] = "hash";
+    printf("stest testing %s\n", test_str);
+
+    unsigned int i;
+    for (i = 0; i < HASH_REPS; ++i)
+    {
+        jarr_set_isa((enum jarr_isa) rand_limited(jarr_isa_count));
+        size_t const length = rand_limited_nz(HASH_LENGTH);
+        size_t const elements = (length + (sizeof (jarr_element_t)
+                * CHAR_BIT) - 1) / (sizeof (jarr_element_t) * CHAR_BIT);
+        uint64_t const seed = rand_hash();
+
+        // the same with different garbage above length_bits, different with
+        // any bit changed, with another length or with another seed
+        jarr_element_t arr[HASH_KEYS][elements];
+        struct jarr test = jarr_init(arr[0], length);
+        rand_array(&test);
+        uint64_t const h = jarr_hash(&test, seed);
+        *test.last_element ^= ~test.mask;
+        jassert(jarr_hash(&test, seed) == h, test_str, "garbage");
+        jarr_length_t const bit = rand_limited(length);
+        jarr_toggle(&test, bit);
+        jassert(jarr_hash(&test, seed) != h, test_str, "bit");
+        jarr_toggle(&test, bit);
+        struct jarr const shorter = jarr_init(arr[0], length - 1);
+        jassert(jarr_hash(&shorter, seed) != h, test_str, "length");
+        jassert(jarr_hash(&test, seed + 1U) != h, test_str, "seed");
+
+        // a pool of keys, some the same where they are short, inserted in a
+        // random order with repeats until the set fills
+        size_t k;
+        struct jarr keys[HASH_KEYS];
+        for (k = 0; k < HASH_KEYS; ++k)
+        {
+            keys[k] = jarr_init(arr[k], length);
+            rand_array(&keys[k]);
+        }
+        jarr_element_t set_keys[jarr_hash_set_length(HASH_CAPACITY, length)];
+        uint64_t hashes[HASH_CAPACITY];
+        struct jarr_hash_set set = jarr_hash_set_init(set_keys, hashes,
+                                                      HASH_CAPACITY, length,
+                                                      seed);
+        size_t const limit = HASH_CAPACITY - (HASH_CAPACITY
+                / jarr_hash_set_free_divisor) - 1U;
+        size_t added[HASH_KEYS];
+        size_t count = 0;
+        for (k = 0; k < 2U * HASH_KEYS; ++k)
+        {
+            size_t const key = rand_limited(HASH_KEYS);
+            enum jarr_hash_set_status expected = jarr_hash_set_added;
+            size_t a;
+            for (a = 0; a < count; ++a)
+            {
+                if (jarr_equal(&keys[key], &keys[added[a]]))
+                {
+                    expected = jarr_hash_set_present;
+                }
+            }
+            if ((expected == jarr_hash_set_added) && (count == limit))
+            {
+                expected = jarr_hash_set_full;
+            }
+            if (expected == jarr_hash_set_added)
+            {
+                added[count] = key;
+                ++count;
+            }
+            jassert(jarr_hash_set_insert(&set, &keys[key]) == expected,
+                    test_str, "insert");
+        }
+        jassert(set.count == count, test_str, "count");
+
+        // keys stored clean, and every pool key found if it was added
+        size_t slot;
+        for (slot = 0; slot < HASH_CAPACITY; ++slot)
+        {
+            struct jarr const stored = jarr_hash_set_key(&set, slot);
+            jassert((hashes[slot] == 0) || (*stored.last_element
+                    == jarr_get_lev(&stored)), test_str, "stored");
+        }
+        for (k = 0; k < HASH_KEYS; ++k)
+        {
+            unsigned char expected = 0;
+            size_t a;
+            for (a = 0; a < count; ++a)
+            {
+                expected |= jarr_equal(&keys[k], &keys[added[a]]);
+            }
+            jassert(jarr_hash_set_contains(&set, &keys[k]) == expected,
+                    test_str, "contains");
+        }
+
+        // moved into a set twice the size with another seed
+        jarr_element_t larger_keys[jarr_hash_set_length(2U * HASH_CAPACITY,
+                length)];
+        uint64_t larger_hashes[2U * HASH_CAPACITY];
+        struct jarr_hash_set larger = jarr_hash_set_init(larger_keys,
+                larger_hashes, 2U * HASH_CAPACITY, length, seed ^ 1U);
+        jassert(jarr_hash_set_rehash(&larger, &set) == 0, test_str,
+                "rehash");
+        jassert(larger.count == count, test_str, "rehash count");
+        for (k = 0; k < count; ++k)
+        {
+            jassert(jarr_hash_set_contains(&larger, &keys[added[k]]),
+                    test_str, "rehash contains");
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    printf("%%SUITE_STARTING%% jarr_test\n");
+    printf("stest testing jarr\n");
+    printf("%%SUITE_STARTED%%\n");
+
+    suite_start_time = clock();
+
+    printf("%%TEST_STARTED%% test1 (jarr_test)\n");
     start_time = clock();
     jarr_test_bit_maipulations();
     printf("%%TEST_FINISHED%% time=%fs test1 (jarr_test)\n",
            (double) (clock() - start_time) / CLOCKS_PER_SEC);
 
+    printf("%%TEST_STARTED%% test2 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_element_boundaries();
+    printf("%%TEST_FINISHED%% time=%fs test2 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
     printf("%%TEST_STARTED%% test3 (jarr_test)\n");
     start_time = clock();
     jarr_test_section_clear();
@@ -923,6 +3499,162 @@ int main(int argc, char** argv)
     printf("%%TEST_FINISHED%% time=%fs test13 (jarr_test)\n",
            (double) (clock() - start_time) / CLOCKS_PER_SEC);
 
+    printf("%%TEST_STARTED%% test14 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_bitwise_isa();
+    printf("%%TEST_FINISHED%% time=%fs test14 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test15 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_popcount();
+    printf("%%TEST_FINISHED%% time=%fs test15 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test16 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_popcount_section();
+    printf("%%TEST_FINISHED%% time=%fs test16 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test17 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_rank_select();
+    printf("%%TEST_FINISHED%% time=%fs test17 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test18 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_rank_update();
+    printf("%%TEST_FINISHED%% time=%fs test18 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test19 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_find();
+    printf("%%TEST_FINISHED%% time=%fs test19 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test20 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_foreach();
+    printf("%%TEST_FINISHED%% time=%fs test20 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test21 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_andnot();
+    printf("%%TEST_FINISHED%% time=%fs test21 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test22 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_ternary();
+    printf("%%TEST_FINISHED%% time=%fs test22 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test23 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_sub();
+    printf("%%TEST_FINISHED%% time=%fs test23 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test24 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_mul();
+    printf("%%TEST_FINISHED%% time=%fs test24 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test25 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_roaring();
+    printf("%%TEST_FINISHED%% time=%fs test25 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test26 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_ewah();
+    printf("%%TEST_FINISHED%% time=%fs test26 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test27 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_file();
+    printf("%%TEST_FINISHED%% time=%fs test27 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test28 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_stream();
+    printf("%%TEST_FINISHED%% time=%fs test28 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test29 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_parallel();
+    printf("%%TEST_FINISHED%% time=%fs test29 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test30 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_alloc();
+    printf("%%TEST_FINISHED%% time=%fs test30 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test31 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_arena();
+    printf("%%TEST_FINISHED%% time=%fs test31 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test32 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_atomic();
+    printf("%%TEST_FINISHED%% time=%fs test32 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test33 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_batch();
+    printf("%%TEST_FINISHED%% time=%fs test33 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test34 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_rotate();
+    printf("%%TEST_FINISHED%% time=%fs test34 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test35 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_permute();
+    printf("%%TEST_FINISHED%% time=%fs test35 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test36 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_matrix();
+    printf("%%TEST_FINISHED%% time=%fs test36 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test37 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_bloom();
+    printf("%%TEST_FINISHED%% time=%fs test37 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test38 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_compare();
+    printf("%%TEST_FINISHED%% time=%fs test38 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
+    printf("%%TEST_STARTED%% test39 (jarr_test)\n");
+    start_time = clock();
+    jarr_test_hash();
+    printf("%%TEST_FINISHED%% time=%fs test39 (jarr_test)\n",
+           (double) (clock() - start_time) / CLOCKS_PER_SEC);
+
     printf("%%SUITE_FINISHED%% time=%fs\n", (double) (clock()
            - suite_start_time) / CLOCKS_PER_SEC);
 